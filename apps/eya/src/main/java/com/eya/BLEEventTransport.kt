@@ -21,8 +21,11 @@ import android.os.Build
 import android.os.Handler
 import android.os.Looper
 import android.os.ParcelUuid
+import android.os.SystemClock
+import android.util.Log
 import androidx.annotation.RequiresPermission
 import androidx.core.app.ActivityCompat
+import org.json.JSONObject
 import java.util.UUID
 
 class BLEEventTransport(private val context: Context)  {
@@ -88,8 +91,22 @@ class BLEEventTransport(private val context: Context)  {
     private var lastSentEventMainIndex: Int = -1
     private var lastSentEventSubIndex: Int = -1
     private var lastSentEventTime: Long = 0
+    // Cihaz seq gönderiyorsa duplicate kontrolü seq ile yapılır (aynı öğeye dönüş / tekrar SETTLE düşmez)
+    private var lastSentEventSeq: Long = -1
     private val DUPLICATE_COMMAND_THRESHOLD_MS = 2000L // 2 saniye içinde aynı komut tekrar gelirse duplicate say
     
+    // Saat senkronu (NTP tarzı ping/pong) - cihaz offset/drift'i hesaplar,
+    // event'lere telefon zamanında "pts" ekler. Zamanlar: elapsedRealtime (µs)
+    private var syncSeq: Long = 0
+    private var pendingSyncSeq: Long = -1      // Cevap bekleyen ping
+    private var pendingSyncT1: Long = 0
+    private var completedSyncSeq: Long = -1    // t4'ü bir sonraki ping ile gönderilecek tur
+    private var completedSyncT4: Long = 0
+    private var lastSyncSentAt: Long = 0
+    private val CLOCK_SYNC_FAST_INTERVAL_MS = 100L  // Bağlantı sonrası ilk turlar
+    private val CLOCK_SYNC_INTERVAL_MS = 1000L      // Sürekli bakım
+    private val CLOCK_SYNC_FAST_ROUNDS = 8
+    
     // Callbacks
     var onDeviceFound: ((String) -> Unit)? = null
     var onEventReceived: ((String) -> Unit)? = null
@@ -380,6 +397,8 @@ class BLEEventTransport(private val context: Context)  {
                     lastSentEventMainIndex = -1
                     lastSentEventSubIndex = -1
                     lastSentEventTime = 0
+                    lastSentEventSeq = -1
+                    resetClockSync()
                     onConnectionChanged?.invoke(false)
                 }
                 
@@ -393,7 +412,9 @@ class BLEEventTransport(private val context: Context)  {
         }
         
         override fun onMtuChanged(bluetoothGatt: BluetoothGatt, mtu: Int, status: Int) {
-            // MTU değişikliği - kullanıcı için log gerekmez
+            // MTU değişikliği - kullanıcı için log gerekmez. Cihaz batch'lerini MTU-3'e göre
+            // boyutlandırır; bir notification birden fazla satır taşıyabilir
+            Log.d("BLEEventTransport", "[LINK] mtu=$mtu status=$status")
         }
         
         override fun onServicesDiscovered(bluetoothGatt: BluetoothGatt, status: Int) {
@@ -617,6 +638,9 @@ class BLEEventTransport(private val context: Context)  {
             return
         }
 
+        // Pong için t4: parse'tan önce alınmalı
+        val arrivalUs = SystemClock.elapsedRealtimeNanos() / 1000
+        
         if (value != null && value.isNotEmpty()) {
             val jsonString = String(value, Charsets.UTF_8)
             
@@ -625,66 +649,30 @@ class BLEEventTransport(private val context: Context)  {
             
             // Buffer'a ekle
             packetBuffer.append(jsonString)
-            val combinedJson = packetBuffer.toString()
-            
-            // JSON validation - Tam JSON mu kontrol et
-            val isCompleteJson = try {
-                // JSON'un başında { ve sonunda } veya \n var mı kontrol et
-                val trimmed = combinedJson.trim()
-                trimmed.startsWith("{") && (trimmed.endsWith("}") || trimmed.endsWith("}\n"))
-            } catch (e: Exception) {
-                false
-            }
-            
-            if (isCompleteJson) {
-                // Tam JSON - Duplicate komut kontrolü yap
-                val trimmedJson = combinedJson.trim()
-                val now = System.currentTimeMillis()
-                
-                // Event'i parse et ve komut bilgilerini çıkar
-                val event = com.eya.model.DeviceEvent.fromJson(trimmedJson)
-                
-                if (event != null) {
-                    // Aynı komut (type + mainIndex + subIndex) ve 2 saniye içinde gelmişse duplicate say
-                    val isDuplicateCommand = lastSentEventType == event.type.name &&
-                                            lastSentEventMainIndex == event.mainIndex &&
-                                            lastSentEventSubIndex == event.subIndex &&
-                                            (now - lastSentEventTime) < DUPLICATE_COMMAND_THRESHOLD_MS
-                    
-                    if (isDuplicateCommand) {
-                        // Buffer'ı temizle ama event'i gönderme
-                        packetBuffer.clear()
-                        return
-                    }
-                    
-                    // Son gönderilen komutu kaydet
-                    lastSentEventType = event.type.name
-                    lastSentEventMainIndex = event.mainIndex
-                    lastSentEventSubIndex = event.subIndex
-                    lastSentEventTime = now
+
+            // Cihaz her JSON'u '\n' ile bitirir. Bir notification aynı loop turundaki
+            // birden fazla event'i (MTU'ya göre birleştirilmiş) veya uzun bir JSON'un
+            // bir parçasını taşıyabilir: tamamlanan her satır ayrı işlenir
+            while (true) {
+                val newline = packetBuffer.indexOf("\n")
+                if (newline < 0) {
+                    break
                 }
-                
-                // Buffer'ı temizle ve event'i gönder
-                packetBuffer.clear()
-                
-                // Event alındı - subscribe başarılı demektir
-                lastEventReceivedTime = System.currentTimeMillis()
-                subscribeVerificationHandler?.removeCallbacksAndMessages(null) // Verification timeout'u iptal et
-                
-                // onEventReceived callback'inin set edilip edilmediğini kontrol et
-                if (onEventReceived == null) {
-                    return
+                val line = packetBuffer.substring(0, newline).trim()
+                packetBuffer.delete(0, newline + 1)
+                if (line.isNotEmpty()) {
+                    handleMessage(line, arrivalUs)
                 }
-                
-                // Callback'i main thread'de çağır - UI güncellemeleri için gerekli
-                mainHandler.post {
-                    try {
-                        onEventReceived?.invoke(trimmedJson)
-                    } catch (e: Exception) {
-                        // Ignore
-                    }
-                }
-            } else {
+            }
+
+            // Satır sonu olmadan gelen tam JSON (satır sonu eklemeyen köprü/istemciler)
+            val rest = packetBuffer.toString().trim()
+            if (rest.startsWith("{") && rest.endsWith("}") && isValidJson(rest)) {
+                packetBuffer.clear()
+                handleMessage(rest, arrivalUs)
+            }
+
+            if (packetBuffer.isNotEmpty()) {
                 // Eksik JSON - Buffer'da tut ve bir sonraki paketi bekle
                 // Timeout ekle - 100ms içinde tamamlanmazsa buffer'ı temizle
                 packetBufferTimeoutHandler = Handler(Looper.getMainLooper())
@@ -699,6 +687,74 @@ class BLEEventTransport(private val context: Context)  {
             }
         }
     }
+
+    private fun isValidJson(text: String): Boolean {
+        return try {
+            JSONObject(text)
+            true
+        } catch (e: Exception) {
+            false
+        }
+    }
+
+    // Tek bir tam JSON mesajını işle (pong, event veya tanılama cevabı)
+    private fun handleMessage(trimmedJson: String, arrivalUs: Long) {
+        val now = System.currentTimeMillis()
+        
+        // Saat senkronu cevabı event değildir
+        if (trimmedJson.contains("\"pong\"")) {
+            handlePong(trimmedJson, arrivalUs)
+            return
+        }
+        
+        // Event'i parse et ve komut bilgilerini çıkar
+        val event = com.eya.model.DeviceEvent.fromJson(trimmedJson)
+        
+        if (event != null) {
+            logEventLatency(event, arrivalUs)
+
+            // seq varsa aynı seq duplicate'tir; yoksa aynı komut (type + mainIndex + subIndex)
+            // 2 saniye içinde gelmişse duplicate say
+            val isDuplicateCommand = if (event.seq >= 0) {
+                event.seq == lastSentEventSeq
+            } else {
+                lastSentEventType == event.type.name &&
+                    lastSentEventMainIndex == event.mainIndex &&
+                    lastSentEventSubIndex == event.subIndex &&
+                    (now - lastSentEventTime) < DUPLICATE_COMMAND_THRESHOLD_MS
+            }
+            
+            if (isDuplicateCommand) {
+                // Event'i gönderme
+                return
+            }
+            
+            // Son gönderilen komutu kaydet
+            lastSentEventType = event.type.name
+            lastSentEventMainIndex = event.mainIndex
+            lastSentEventSubIndex = event.subIndex
+            lastSentEventTime = now
+            lastSentEventSeq = event.seq
+        }
+        
+        // Event alındı - subscribe başarılı demektir
+        lastEventReceivedTime = System.currentTimeMillis()
+        subscribeVerificationHandler?.removeCallbacksAndMessages(null) // Verification timeout'u iptal et
+        
+        // onEventReceived callback'inin set edilip edilmediğini kontrol et
+        if (onEventReceived == null) {
+            return
+        }
+        
+        // Callback'i main thread'de çağır - UI güncellemeleri için gerekli
+        mainHandler.post {
+            try {
+                onEventReceived?.invoke(trimmedJson)
+            } catch (e: Exception) {
+                // Ignore
+            }
+        }
+    }
     
     fun isConnected(): Boolean {
         if (bluetoothGatt == null) return false
@@ -843,7 +899,8 @@ class BLEEventTransport(private val context: Context)  {
                         // Write sonrası hemen read yapınca son event'i alacağız
                         
                         // 1. Write request gönder (dummy data ile - sadece trigger için)
-                        val writeData = byteArrayOf(0x01) // Dummy data - bridge server'a "event var mı?" sorusu
+                        // Saat senkronu zamanı geldiyse dummy yerine ping gönderilir (aynı write kuyruğu)
+                        val writeData = nextClockSyncPing() ?: byteArrayOf(0x01) // Dummy data - bridge server'a "event var mı?" sorusu
                         characteristic.value = writeData
                         characteristic.writeType = BluetoothGattCharacteristic.WRITE_TYPE_DEFAULT
                         
@@ -887,6 +944,74 @@ class BLEEventTransport(private val context: Context)  {
         eventPollingHandler?.removeCallbacksAndMessages(null)
         eventPollingHandler = null
         lastReadValue = null
+        resetClockSync()
+    }
+    
+    /**
+     * Zamanı geldiyse saat senkronu ping'ini hazırla, değilse null döner
+     * Format: {"sync":seq,"t1":µs,"ps":öncekiSeq,"p4":öncekiT4µs}
+     * Önceki turun t4'ü bir sonraki ping ile cihaza iletilir; cihaz 4 zaman
+     * damgasını birleştirip offset/drift hesaplar.
+     */
+    private fun nextClockSyncPing(): ByteArray? {
+        val nowMs = SystemClock.elapsedRealtime()
+        val interval = if (syncSeq < CLOCK_SYNC_FAST_ROUNDS) CLOCK_SYNC_FAST_INTERVAL_MS else CLOCK_SYNC_INTERVAL_MS
+        if (nowMs - lastSyncSentAt < interval) {
+            return null
+        }
+        lastSyncSentAt = nowMs
+        syncSeq++
+        
+        val ping = StringBuilder()
+        ping.append("{\"sync\":").append(syncSeq)
+        pendingSyncSeq = syncSeq
+        pendingSyncT1 = SystemClock.elapsedRealtimeNanos() / 1000
+        ping.append(",\"t1\":").append(pendingSyncT1)
+        if (completedSyncSeq >= 0) {
+            ping.append(",\"ps\":").append(completedSyncSeq)
+            ping.append(",\"p4\":").append(completedSyncT4)
+            completedSyncSeq = -1
+        }
+        ping.append("}")
+        return ping.toString().toByteArray(Charsets.UTF_8)
+    }
+    
+    /**
+     * Pong alındı: t4'ü kaydet (bir sonraki ping ile cihaza gönderilecek)
+     */
+    private fun handlePong(json: String, arrivalUs: Long) {
+        try {
+            val seq = org.json.JSONObject(json).getLong("pong")
+            // Read-polling ile aynı pong tekrar okunabilir; sadece ilk gelen sayılır
+            if (seq != pendingSyncSeq) {
+                return
+            }
+            pendingSyncSeq = -1
+            completedSyncSeq = seq
+            completedSyncT4 = arrivalUs
+        } catch (e: Exception) {
+            // Ignore
+        }
+    }
+    
+    private fun resetClockSync() {
+        syncSeq = 0
+        pendingSyncSeq = -1
+        completedSyncSeq = -1
+        lastSyncSentAt = 0
+    }
+    
+    /**
+     * Uçtan uca gecikme ayrıştırması (cihaz senkronluysa):
+     * device = cihaz içi gecikme (sd), radio = BLE + Android stack
+     */
+    private fun logEventLatency(event: com.eya.model.DeviceEvent, arrivalUs: Long) {
+        if (event.pts < 0) {
+            return
+        }
+        val totalMs = arrivalUs / 1000 - event.pts
+        val deviceMs = if (event.sd >= 0) event.sd else 0
+        Log.d("BLEEventTransport", "[LAT] ${event.type} device=${deviceMs}ms radio=${totalMs - deviceMs}ms total=${totalMs}ms")
     }
 }
 
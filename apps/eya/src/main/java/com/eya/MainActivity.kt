@@ -281,6 +281,7 @@ fun AppScreen() {
     val securityHandler = remember { SecurityHandler(context) }
     val aiHandler = remember { AIHandler() }
     val voiceHandler = remember { VoiceHandler(context) }
+    val rotateAnnounceHandler = remember { RotateAnnounceHandler(ttsManager) }
     
     // Menu navigation state
     var currentMainIndex by remember { mutableStateOf(0) }
@@ -336,6 +337,7 @@ fun AppScreen() {
                     securityHandler = securityHandler,
                     aiHandler = aiHandler,
                     voiceHandler = voiceHandler,
+                    rotateAnnounceHandler = rotateAnnounceHandler,
                     voiceCommandManager = voiceCommandManager,
                     sttTranscribedText = sttTranscribedText,
                     onSttText = { sttTranscribedText = it },
@@ -675,6 +677,7 @@ private fun handleDeviceEvent(
     securityHandler: SecurityHandler,
     aiHandler: AIHandler,
     voiceHandler: VoiceHandler,
+    rotateAnnounceHandler: RotateAnnounceHandler,
     voiceCommandManager: VoiceCommandManager,
     sttTranscribedText: String?,
     onSttText: (String) -> Unit,
@@ -692,8 +695,8 @@ private fun handleDeviceEvent(
             onMainIndexChanged(mainIndex)
             val name = menuManager.getMainMenuName(mainIndex, language)
             if (name != null) {
-                ttsManager.speak(name, language)
-                onLog("MAIN_ROTATE -> $name")
+                rotateAnnounceHandler.onRotate(name, event, language)
+                onLog("MAIN_ROTATE -> $name (v=${event.v})")
             }
         }
         EventType.SUB_ROTATE -> {
@@ -706,17 +709,26 @@ private fun handleDeviceEvent(
             
             // Seslendirme menüsü için özel işlem
             if (currentMainIndex == 11) {
+                rotateAnnounceHandler.cancel()
                 voiceHandler.handleVoiceRotate(subIndex, language)
                 onLog("SUB_ROTATE -> Voice $subIndex")
             } else {
                 val name = menuManager.getSubMenuName(currentMainIndex, subIndex, language)
                 if (name != null) {
-                    ttsManager.speak(name, language)
-                    onLog("SUB_ROTATE -> $name")
+                    rotateAnnounceHandler.onRotate(name, event, language)
+                    onLog("SUB_ROTATE -> $name (v=${event.v})")
                 }
             }
         }
+        EventType.SETTLE -> {
+            // Hızlı dönüşte atlanan öğeyi şimdi seslendir
+            rotateAnnounceHandler.onSettle(event, language)
+            // Seçili öğenin verisini CONFIRM'den önce hazırlamaya başla
+            prefetchSelection(currentMainIndex, currentSubIndex, language, weatherHandler, locationHandler)
+            onLog("SETTLE -> $currentMainIndex/$currentSubIndex")
+        }
         EventType.CONFIRM -> {
+            rotateAnnounceHandler.cancel()
             // Radyo açıksa kapat
             if (radioHandler.isPlaying()) {
                 radioHandler.stopRadio()
@@ -741,6 +753,7 @@ private fun handleDeviceEvent(
             )
         }
         EventType.AI_PRESS -> {
+            rotateAnnounceHandler.cancel()
             // Radyo açıksa kapat
             if (radioHandler.isPlaying()) {
                 radioHandler.stopRadio()
@@ -843,6 +856,22 @@ private fun handleDeviceEvent(
     }
 }
 
+// SETTLE: Kullanıcının durduğu öğe ağ/konum gerektiriyorsa sorguyu önceden başlat
+private fun prefetchSelection(
+    mainIndex: Int,
+    subIndex: Int,
+    language: String,
+    weatherHandler: WeatherHandler,
+    locationHandler: LocationHandler
+) {
+    when (mainIndex) {
+        1 -> weatherHandler.prefetch(subIndex, language) // Hava Durumu
+        2 -> if (subIndex == 0 || subIndex == 2) {       // Mevcut Konum / Çevremde Ne Var
+            locationHandler.prefetchLocation()
+        }
+    }
+}
+
 private fun handleMenuConfirm(
     mainIndex: Int,
     subIndex: Int,
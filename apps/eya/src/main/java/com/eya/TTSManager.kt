@@ -1,7 +1,9 @@
 package com.eya
 
 import android.content.Context
+import android.os.SystemClock
 import android.speech.tts.TextToSpeech
+import android.speech.tts.UtteranceProgressListener
 import android.util.Log
 import org.json.JSONObject
 import java.util.Locale
@@ -11,6 +13,10 @@ class TTSManager(private val context: Context) : TextToSpeech.OnInitListener {
     private var ready = false
     private val voices: List<VoiceInfo>
     private var currentVoiceId: String
+    
+    // Utterance -> cihazdaki event anı (pts, telefon elapsedRealtime ms)
+    // Konuşma başladığında input -> ses gecikmesini loglamak için
+    private val utteranceOrigins = java.util.concurrent.ConcurrentHashMap<String, Long>()
 
     data class VoiceInfo(val id: String, val name: String, val language: String, val provider: String? = null, val gender: String? = null)
 
@@ -46,6 +52,20 @@ class TTSManager(private val context: Context) : TextToSpeech.OnInitListener {
             // Android TTS seslerini listele
             val availableVoices = tts?.voices
             Log.d("TTSManager", "Mevcut Android TTS sesleri: ${availableVoices?.size ?: 0}")
+            
+            tts?.setOnUtteranceProgressListener(object : UtteranceProgressListener() {
+                override fun onStart(utteranceId: String) {
+                    val pts = utteranceOrigins.remove(utteranceId) ?: return
+                    Log.d("TTSManager", "[LAT] input->speech=${SystemClock.elapsedRealtime() - pts}ms")
+                }
+                override fun onDone(utteranceId: String) {
+                    utteranceOrigins.remove(utteranceId)
+                }
+                @Deprecated("Deprecated in Java")
+                override fun onError(utteranceId: String) {
+                    utteranceOrigins.remove(utteranceId)
+                }
+            })
         }
     }
 
@@ -66,7 +86,8 @@ class TTSManager(private val context: Context) : TextToSpeech.OnInitListener {
 
     fun getVoices(): List<VoiceInfo> = voices
 
-    fun speak(text: String, language: String) {
+    // originPts: Cihaz event'inin telefon zamanındaki anı (DeviceEvent.pts), yoksa -1
+    fun speak(text: String, language: String, originPts: Long = -1) {
         if (!ready) {
             Log.e("TTSManager", "TTS hazır değil")
             return
@@ -75,7 +96,16 @@ class TTSManager(private val context: Context) : TextToSpeech.OnInitListener {
         Log.d("TTSManager", "Android TTS ile konuşuluyor: '$text'")
         val locale = if (language == "en") Locale.US else Locale("tr", "TR")
         tts?.language = locale
-        tts?.speak(text, TextToSpeech.QUEUE_FLUSH, null, "tts-${System.currentTimeMillis()}")
+        val utteranceId = "tts-${System.currentTimeMillis()}"
+        if (originPts >= 0) {
+            utteranceOrigins[utteranceId] = originPts
+        }
+        tts?.speak(text, TextToSpeech.QUEUE_FLUSH, null, utteranceId)
+    }
+
+    // Süren/kuyruktaki konuşmayı kes (ör. hızlı çevirmede eskiyen öğe adı)
+    fun stop() {
+        tts?.stop()
     }
 
     fun shutdown() {
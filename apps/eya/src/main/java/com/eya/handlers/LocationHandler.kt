@@ -8,13 +8,17 @@ import android.hardware.SensorEventListener
 import android.hardware.SensorManager
 import android.location.Address
 import android.location.Geocoder
+import android.location.Location
+import android.os.SystemClock
 import androidx.core.content.ContextCompat
 import com.eya.TTSManager
 import com.google.android.gms.location.FusedLocationProviderClient
 import com.google.android.gms.location.LocationServices
 import com.google.android.gms.location.Priority
 import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Deferred
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.tasks.await
 import java.util.Locale
@@ -24,6 +28,48 @@ class LocationHandler(private val context: Context) {
         LocationServices.getFusedLocationProviderClient(context)
     private val sensorManager = context.getSystemService(Context.SENSOR_SERVICE) as SensorManager
     private var compassListener: SensorEventListener? = null
+
+    // SETTLE ile önceden başlatılan konum sorgusu (GPS fix'i CONFIRM'den önce başlar)
+    private var prefetchJob: Deferred<Location?>? = null
+    private var prefetchTime = 0L
+    private val PREFETCH_MAX_AGE_MS = 30_000L
+
+    // Kullanıcı konum öğesinde durdu: konumu sessizce almaya başla (izin yoksa yok say)
+    fun prefetchLocation() {
+        if (ContextCompat.checkSelfPermission(context, android.Manifest.permission.ACCESS_FINE_LOCATION) != 
+            PackageManager.PERMISSION_GRANTED &&
+            ContextCompat.checkSelfPermission(context, android.Manifest.permission.ACCESS_COARSE_LOCATION) != 
+            PackageManager.PERMISSION_GRANTED) {
+            return
+        }
+        if (prefetchJob != null && SystemClock.elapsedRealtime() - prefetchTime < PREFETCH_MAX_AGE_MS) {
+            return
+        }
+        prefetchTime = SystemClock.elapsedRealtime()
+        prefetchJob = CoroutineScope(Dispatchers.Main).async {
+            try {
+                fusedLocationClient.getCurrentLocation(Priority.PRIORITY_HIGH_ACCURACY, null).await()
+            } catch (e: Exception) {
+                null
+            }
+        }
+    }
+
+    // Taze prefetch varsa onu kullan (bir kez), yoksa konumu şimdi al
+    private suspend fun currentLocation(): Location? {
+        val job = prefetchJob
+        prefetchJob = null
+        if (job != null && SystemClock.elapsedRealtime() - prefetchTime < PREFETCH_MAX_AGE_MS) {
+            val location = job.await()
+            if (location != null) {
+                return location
+            }
+        }
+        return fusedLocationClient.getCurrentLocation(
+            Priority.PRIORITY_HIGH_ACCURACY,
+            null
+        ).await()
+    }
     
     fun handleCurrentLocation(
         ttsManager: TTSManager,
@@ -42,10 +88,7 @@ class LocationHandler(private val context: Context) {
         val scope = CoroutineScope(Dispatchers.Main)
         scope.launch {
             try {
-                val location = fusedLocationClient.getCurrentLocation(
-                    Priority.PRIORITY_HIGH_ACCURACY,
-                    null
-                ).await()
+                val location = currentLocation()
                 
                 if (location != null) {
                     val geocoder = Geocoder(context, Locale.getDefault())
@@ -147,10 +190,7 @@ class LocationHandler(private val context: Context) {
         val scope = CoroutineScope(Dispatchers.Main)
         scope.launch {
             try {
-                val location = fusedLocationClient.getCurrentLocation(
-                    Priority.PRIORITY_HIGH_ACCURACY,
-                    null
-                ).await()
+                val location = currentLocation()
                 
                 if (location != null) {
                     val geocoder = Geocoder(context, Locale.getDefault())
@@ -0,0 +1,58 @@
+package com.eya.handlers
+
+import android.os.Handler
+import android.os.Looper
+import com.eya.TTSManager
+import com.eya.model.DeviceEvent
+
+// Rotate seslendirmesi: hızlı çevirmede ara öğeler okunmaz, kullanıcının durduğu
+// öğe SETTLE ile okunur. SETTLE gelmezse (cihazda kapalı: {"settle":0}, kayıp event)
+// son öğe zaman aşımıyla yine okunur.
+class RotateAnnounceHandler(private val ttsManager: TTSManager) {
+    companion object {
+        // Bu hızın (adım/sn) üstündeki dönüşlerde ara öğeler seslendirilmez
+        const val FAST_ROTATE_STEPS_PER_S = 6
+
+        // Cihazın varsayılan dwell süresi (400ms) + BLE gecikmesi payı
+        const val SETTLE_FALLBACK_MS = 1200L
+    }
+
+    private val mainHandler = Handler(Looper.getMainLooper())
+
+    // Hızlı dönüşte atlanan son öğe adı (SETTLE veya zaman aşımında seslendirilir)
+    private var pendingName: String? = null
+    private var pendingLanguage = "tr"
+
+    private val fallback = Runnable {
+        val name = pendingName ?: return@Runnable
+        pendingName = null
+        ttsManager.speak(name, pendingLanguage)
+    }
+
+    fun onRotate(name: String, event: DeviceEvent, language: String) {
+        mainHandler.removeCallbacks(fallback)
+        if (event.v >= FAST_ROTATE_STEPS_PER_S) {
+            ttsManager.stop()
+            pendingName = name
+            pendingLanguage = language
+            mainHandler.postDelayed(fallback, SETTLE_FALLBACK_MS)
+        } else {
+            pendingName = null
+            ttsManager.speak(name, language, event.pts)
+        }
+    }
+
+    fun onSettle(event: DeviceEvent, language: String) {
+        mainHandler.removeCallbacks(fallback)
+        pendingName?.let { name ->
+            ttsManager.speak(name, language, event.pts)
+        }
+        pendingName = null
+    }
+
+    // Kullanıcı karar verdi (CONFIRM): bekleyen ad artık okunmaz
+    fun cancel() {
+        mainHandler.removeCallbacks(fallback)
+        pendingName = null
+    }
+}
@@ -3,6 +3,7 @@ package com.eya.handlers
 import android.content.Context
 import android.content.pm.PackageManager
 import android.location.Geocoder
+import android.os.SystemClock
 import androidx.core.content.ContextCompat
 import com.eya.TTSManager
 import com.eya.utils.WeatherClient
@@ -10,7 +11,9 @@ import com.google.android.gms.location.FusedLocationProviderClient
 import com.google.android.gms.location.LocationServices
 import com.google.android.gms.location.Priority
 import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Deferred
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
 import kotlinx.coroutines.launch
 import kotlinx.coroutines.tasks.await
 import java.util.Locale
@@ -21,6 +24,16 @@ class WeatherHandler(private val context: Context) {
     private val fusedLocationClient: FusedLocationProviderClient = 
         LocationServices.getFusedLocationProviderClient(context)
     
+    // Sorgu sonucu: seslendirilecek metin veya hata mesajı
+    private data class WeatherResult(val text: String, val isError: Boolean)
+
+    // SETTLE ile önceden başlatılan sorgu (CONFIRM geldiğinde hazırsa beklemeden okunur)
+    private var prefetchJob: Deferred<WeatherResult>? = null
+    private var prefetchDays = -1
+    private var prefetchLanguage = ""
+    private var prefetchTime = 0L
+    private val PREFETCH_MAX_AGE_MS = 60_000L
+
     fun handleWeather(
         subIndex: Int,
         ttsManager: TTSManager,
@@ -28,23 +41,67 @@ class WeatherHandler(private val context: Context) {
         onError: (String) -> Unit
     ) {
         // İzin kontrolü
-        if (ContextCompat.checkSelfPermission(context, android.Manifest.permission.ACCESS_FINE_LOCATION) != 
-            PackageManager.PERMISSION_GRANTED &&
-            ContextCompat.checkSelfPermission(context, android.Manifest.permission.ACCESS_COARSE_LOCATION) != 
-            PackageManager.PERMISSION_GRANTED) {
+        if (!hasLocationPermission()) {
             val text = if (language == "tr") "Konum izni gerekli" else "Location permission required"
             ttsManager.speak(text, language)
             return
         }
-        val days = when (subIndex) {
+        val days = daysFor(subIndex)
+        val job = takePrefetch(days, language) ?: fetchAsync(days, language)
+
+        scope.launch {
+            val result = job.await()
+            if (result.isError) {
+                onError(result.text)
+            } else {
+                ttsManager.speak(result.text, language)
+            }
+        }
+    }
+
+    // Kullanıcı hava durumu öğesinde durdu: sorguyu CONFIRM'den önce başlat (sessiz, izin yoksa yok say)
+    fun prefetch(subIndex: Int, language: String) {
+        if (!hasLocationPermission()) {
+            return
+        }
+        val days = daysFor(subIndex)
+        val fresh = SystemClock.elapsedRealtime() - prefetchTime < PREFETCH_MAX_AGE_MS
+        if (prefetchJob != null && fresh && prefetchDays == days && prefetchLanguage == language) {
+            return
+        }
+        prefetchJob = fetchAsync(days, language)
+        prefetchDays = days
+        prefetchLanguage = language
+        prefetchTime = SystemClock.elapsedRealtime()
+    }
+
+    // Uygun (aynı gün sayısı/dil, taze) prefetch varsa al ve tüket
+    private fun takePrefetch(days: Int, language: String): Deferred<WeatherResult>? {
+        val job = prefetchJob ?: return null
+        prefetchJob = null
+        val fresh = SystemClock.elapsedRealtime() - prefetchTime < PREFETCH_MAX_AGE_MS
+        return if (fresh && prefetchDays == days && prefetchLanguage == language) job else null
+    }
+
+    private fun hasLocationPermission(): Boolean {
+        return ContextCompat.checkSelfPermission(context, android.Manifest.permission.ACCESS_FINE_LOCATION) ==
+            PackageManager.PERMISSION_GRANTED ||
+            ContextCompat.checkSelfPermission(context, android.Manifest.permission.ACCESS_COARSE_LOCATION) ==
+            PackageManager.PERMISSION_GRANTED
+    }
+
+    private fun daysFor(subIndex: Int): Int {
+        return when (subIndex) {
             0 -> 1  // Bugün
             1 -> 2  // Yarın
             2 -> 7  // Bu Hafta
             3 -> 14 // Önümüzdeki Hafta
             else -> 1
         }
-        
-        scope.launch {
+    }
+
+    private fun fetchAsync(days: Int, language: String): Deferred<WeatherResult> {
+        return scope.async {
             try {
                 // Önce konum al
                 val location = fusedLocationClient.getCurrentLocation(
@@ -53,8 +110,7 @@ class WeatherHandler(private val context: Context) {
                 ).await()
                 
                 if (location == null) {
-                    onError(if (language == "tr") "Konum alınamadı" else "Could not get location")
-                    return@launch
+                    return@async WeatherResult(if (language == "tr") "Konum alınamadı" else "Could not get location", true)
                 }
                 
                 // Şehir ve semt bilgisini al
@@ -82,14 +138,14 @@ class WeatherHandler(private val context: Context) {
                     } else {
                         weatherData
                     }
-                    ttsManager.speak(finalText, language)
+                    WeatherResult(finalText, false)
                 } else {
                     val errorMsg = if (language == "tr") {
                         "Hava durumu bilgisi alınamadı"
                     } else {
                         "Could not get weather information"
                     }
-                    onError(errorMsg)
+                    WeatherResult(errorMsg, true)
                 }
             } catch (e: Exception) {
                 val errorMsg = if (language == "tr") {
@@ -97,9 +153,8 @@ class WeatherHandler(private val context: Context) {
                 } else {
                     "Error getting weather information"
                 }
-                onError(errorMsg)
+                WeatherResult(errorMsg, true)
             }
         }
     }
 }
-
@@ -6,7 +6,15 @@ data class DeviceEvent(
     val type: EventType,
     val mainIndex: Int = 0,
     val subIndex: Int = 0,
-    val ts: Long = 0
+    val ts: Long = 0,
+    // Event sıra numarası (cihaz açılışından beri), yoksa -1
+    val seq: Long = -1,
+    // Rotate event'lerinde dönüş hızı (adım/sn, 0 = tek adım / yavaş)
+    val v: Int = 0,
+    // Saat senkronu varsa: event anı telefon zamanında (SystemClock.elapsedRealtime, ms)
+    val pts: Long = -1,
+    // Cihaz içinde event yakalama -> gönderim arası süre (ms)
+    val sd: Long = -1
 ) {
     companion object {
         fun fromJson(jsonString: String): DeviceEvent? {
@@ -19,7 +27,11 @@ data class DeviceEvent(
                     type = type,
                     mainIndex = json.optInt("mainIndex", 0),
                     subIndex = json.optInt("subIndex", 0),
-                    ts = json.optLong("ts", 0)
+                    ts = json.optLong("ts", 0),
+                    seq = json.optLong("seq", -1),
+                    v = json.optInt("v", 0),
+                    pts = json.optLong("pts", -1),
+                    sd = json.optLong("sd", -1)
                 )
             } catch (e: Exception) {
                 null
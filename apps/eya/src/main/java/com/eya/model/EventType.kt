@@ -6,7 +6,8 @@ enum class EventType(val value: Int) {
     CONFIRM(2),
     EVENT_CANCEL(3),
     AI_PRESS(4),
-    AI_RELEASE(5);
+    AI_RELEASE(5),
+    SETTLE(6);      // Kullanıcı bir öğede durdu (dwell süresi boyunca dönüş yok)
     
     companion object {
         fun fromInt(value: Int): EventType? {
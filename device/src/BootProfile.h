@@ -0,0 +1,126 @@
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <esp_system.h>
+
+/* =========================================================
+   BOOT PROFILE (Açılış Süresi Ölçümü)
+   =========================================================
+
+   Açılış aşamalarının zaman damgalarını (micros) tutar ve
+   Serial'e tek satırlık bir özet basar. Soğuk açılış ve
+   uykudan uyanma ayrı raporlanır; böylece "ilk event'e kadar
+   geçen süre" regresyon metriği olarak takip edilebilir.
+
+   Not: micros() uygulama başladığında sıfırdan sayar, ROM
+   bootloader süresi bu ölçüme dahil değildir.
+
+   Log formatı (log analizi için sabit tutun):
+   [BOOT] phase=input_armed t=1834us
+   [BOOT] summary boot=cold reset=POWERON input_armed=1834us ...
+*/
+
+enum BootPhase : uint8_t {
+  BOOT_SETUP_START = 0,  // setup() ilk satırı
+  BOOT_INPUT_ARMED,      // Encoder ve butonlar okunmaya hazır
+  BOOT_BLE_STARTED,      // BLE başlatma task'ı oluşturuldu
+  BOOT_FIRST_LOOP,       // loop() ilk kez çalıştı
+  BOOT_BLE_READY,        // BLE stack + GATT server + advertising hazır
+  BOOT_FIRST_EVENT,      // İlk kullanıcı event'i gönderildi
+  BOOT_PHASE_COUNT
+};
+
+class BootProfile {
+public:
+  // Açılış türünü belirle ve setup başlangıcını işaretle
+  void begin() {
+    _wake = esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_UNDEFINED;
+    _reset = esp_reset_reason();
+    mark(BOOT_SETUP_START);
+  }
+
+  // Aşamayı şu anki zamanla işaretle (her aşama sadece bir kez)
+  void mark(BootPhase phase) {
+    markAt(phase, micros());
+  }
+
+  // Aşamayı verilen zamanla işaretle (başka task'ta ölçülen zamanlar için)
+  void markAt(BootPhase phase, uint32_t us) {
+    if (phase >= BOOT_PHASE_COUNT || _marked[phase]) {
+      return;
+    }
+    _times[phase] = us;
+    _marked[phase] = true;
+
+    Serial.print("[BOOT] phase=");
+    Serial.print(phaseName(phase));
+    Serial.print(" t=");
+    Serial.print(us);
+    Serial.println("us");
+
+    if (phase == BOOT_FIRST_EVENT) {
+      printSummary();
+    }
+  }
+
+  bool isMarked(BootPhase phase) const {
+    return phase < BOOT_PHASE_COUNT && _marked[phase];
+  }
+
+  bool isWake() const { return _wake; }
+
+  // Tüm işaretli aşamaları tek satırda bas (regresyon takibi için)
+  void printSummary() const {
+    Serial.print("[BOOT] summary boot=");
+    Serial.print(_wake ? "wake" : "cold");
+    Serial.print(" reset=");
+    Serial.print(resetName(_reset));
+    for (uint8_t i = BOOT_INPUT_ARMED; i < BOOT_PHASE_COUNT; i++) {
+      if (!_marked[i]) {
+        continue;
+      }
+      Serial.print(" ");
+      Serial.print(phaseName((BootPhase)i));
+      Serial.print("=");
+      Serial.print(_times[i]);
+      Serial.print("us");
+    }
+    Serial.println();
+  }
+
+  static const char* phaseName(BootPhase phase) {
+    switch (phase) {
+      case BOOT_SETUP_START: return "setup_start";
+      case BOOT_INPUT_ARMED: return "input_armed";
+      case BOOT_BLE_STARTED: return "ble_started";
+      case BOOT_FIRST_LOOP:  return "first_loop";
+      case BOOT_BLE_READY:   return "ble_ready";
+      case BOOT_FIRST_EVENT: return "first_event";
+      default:               return "unknown";
+    }
+  }
+
+  static const char* resetName(esp_reset_reason_t reason) {
+    switch (reason) {
+      case ESP_RST_POWERON:  return "POWERON";
+      case ESP_RST_SW:       return "SW";
+      case ESP_RST_PANIC:    return "PANIC";
+      case ESP_RST_INT_WDT:  return "INT_WDT";
+      case ESP_RST_TASK_WDT: return "TASK_WDT";
+      case ESP_RST_WDT:      return "WDT";
+      case ESP_RST_DEEPSLEEP: return "DEEPSLEEP";
+      case ESP_RST_BROWNOUT: return "BROWNOUT";
+      default:               return "OTHER";
+    }
+  }
+
+private:
+  uint32_t _times[BOOT_PHASE_COUNT] = {0};
+  bool _marked[BOOT_PHASE_COUNT] = {false};
+  bool _wake = false;
+  esp_reset_reason_t _reset = ESP_RST_UNKNOWN;
+};
+
+#endif // BOOT_PROFILE_H
@@ -0,0 +1,250 @@
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+
+/* =========================================================
+   CLOCK SYNC (Cihaz - Telefon Saat Senkronizasyonu)
+   =========================================================
+
+   NTP tarzı offset/drift tahmini. Telefon BLE characteristic'e
+   ping yazar, cihaz pong ile cevap verir. Her tur 4 zaman
+   damgası üretir (hepsi µs):
+
+     t1: Telefon ping'i gönderdi   (telefon saati)
+     t2: Cihaz ping'i aldı         (cihaz saati)
+     t3: Cihaz pong'u gönderdi     (cihaz saati)
+     t4: Telefon pong'u aldı       (telefon saati)
+
+     offset = ((t2 - t1) + (t3 - t4)) / 2   (cihaz - telefon)
+     delay  = (t4 - t1) - (t3 - t2)         (gidiş-dönüş radyo süresi)
+
+   BLE connection interval'ı yüzünden delay çok oynak ve çoğu zaman
+   asimetriktir (tek yönde yeniden iletim). Tek turun offset hatası
+   (gidiş - dönüş) / 2'dir; bu yüzden turlar ortalanmaz, sınır olarak
+   kullanılır. Gecikmeler pozitif olduğundan her tur offset'i bir
+   aralığa hapseder:
+
+     t3 - t4  <  offset  <  t2 - t1
+
+   - Offset: penceredeki turların (drift ile aynı ana taşınmış)
+     aralıklarının kesişiminin ortası. Üst sınır en hızlı gidişten, alt
+     sınır en hızlı dönüşten gelir; tek yönlü büyük gecikmeler sadece
+     kendi sınırını gevşetir, tahmini kaydırmaz.
+   - Drift: her BLOCK turun kesişim ortası bir "epoch" noktası olur;
+     drift, epoch noktalarından en küçük kareler ile çıkarılır. Uzun
+     taban çizgisi (dakikalar) kalan jitter'ın eğimi bozmasını engeller.
+
+   Hata sınırları tools/host-tests/src/ClockSyncTest.cpp'de
+   (40ppm drift, üstel jitter, asimetrik outlier) doğrulanır.
+
+   Bu sınıf Arduino'ya bağımlı değildir (host'ta derlenebilir).
+*/
+
+class ClockSync {
+public:
+  static const uint8_t WINDOW = 32;       // Offset için saklanan son örnek sayısı
+  static const uint8_t BLOCK = 16;        // Kaç örnekte bir epoch noktası alınır
+  static const uint8_t EPOCHS = 16;       // Drift için saklanan epoch noktası sayısı
+  static const uint8_t MIN_SAMPLES = 3;   // Senkron sayılmak için gereken örnek
+  static const int64_t MAX_DELAY_US = 500000; // Bundan uzun turlar kullanılmaz
+  static const int64_t MIN_DRIFT_SPAN_US = 60000000; // Drift için en az 60 sn taban
+  static constexpr double MAX_DRIFT = 200e-6;  // Kristal toleransının çok üstü: daha büyüğü hatalı fit
+
+  // Yeni bir ping/pong turu ekle. Return: örnek kabul edildi mi?
+  bool addSample(int64_t t1, int64_t t2, int64_t t3, int64_t t4) {
+    int64_t delay = (t4 - t1) - (t3 - t2);
+    if (delay < 0 || delay > MAX_DELAY_US || t3 < t2) {
+      return false;  // Bozuk veya çok gecikmiş tur
+    }
+
+    Sample s;
+    s.local = t2 + (t3 - t2) / 2;
+    s.hi = t2 - t1;  // offset + gidiş
+    s.lo = t3 - t4;  // offset - dönüş
+
+    _samples[_head] = s;
+    _head = (_head + 1) % WINDOW;
+    if (_count < WINDOW) {
+      _count++;
+    }
+    _lastLocal = s.local;
+
+    // Blok içindeki aralıkları bloğun ilk örneğinin anında kesiştir
+    if (_blockCount == 0) {
+      _blockLocal = s.local;
+      _blockHi = s.hi;
+      _blockLo = s.lo;
+    } else {
+      int64_t shift = (int64_t)(_drift * (double)(_blockLocal - s.local));
+      if (s.hi + shift < _blockHi) {
+        _blockHi = s.hi + shift;
+      }
+      if (s.lo + shift > _blockLo) {
+        _blockLo = s.lo + shift;
+      }
+    }
+    if (++_blockCount >= BLOCK) {
+      pushEpoch(_blockLocal, _blockHi + (_blockLo - _blockHi) / 2);
+      _blockCount = 0;
+    }
+
+    fit();
+    return true;
+  }
+
+  void reset() {
+    _count = 0;
+    _head = 0;
+    _blockCount = 0;
+    _epochCount = 0;
+    _epochHead = 0;
+    _synced = false;
+    _offset = 0;
+    _drift = 0.0;
+    _refLocal = 0;
+    _lastLocal = 0;
+    _bestDelay = 0;
+  }
+
+  bool isSynced() const { return _synced; }
+
+  // Verilen cihaz zamanında (µs) tahmini offset (cihaz - telefon)
+  int64_t offsetAt(int64_t localUs) const {
+    return _offset + (int64_t)(_drift * (double)(localUs - _refLocal));
+  }
+
+  // Cihaz zamanını (µs) telefon zamanına (µs) çevir
+  int64_t toRemote(int64_t localUs) const {
+    return localUs - offsetAt(localUs);
+  }
+
+  // Telefon saatine göre cihaz saatinin kayması (ppm)
+  double driftPpm() const { return _drift * 1e6; }
+
+  // Son penceredeki en düşük gidiş-dönüş süresi (µs)
+  int64_t bestDelay() const { return _bestDelay; }
+
+  uint8_t sampleCount() const { return _count; }
+
+  // Son örnekten bu yana geçen süre (cihaz µs), tazelik kontrolü için
+  int64_t ageAt(int64_t localUs) const { return localUs - _lastLocal; }
+
+private:
+  struct Sample {
+    int64_t local;   // Turun cihaz saatindeki orta noktası
+    int64_t hi;      // Offset üst sınırı (t2 - t1)
+    int64_t lo;      // Offset alt sınırı (t3 - t4)
+  };
+
+  struct Epoch {
+    int64_t local;
+    int64_t offset;  // Bloğun kesişim ortası
+  };
+
+  Sample _samples[WINDOW];
+  uint8_t _count = 0;
+  uint8_t _head = 0;
+
+  int64_t _blockLocal = 0;
+  int64_t _blockHi = 0;
+  int64_t _blockLo = 0;
+  uint8_t _blockCount = 0;
+  Epoch _epochs[EPOCHS];
+  uint8_t _epochCount = 0;
+  uint8_t _epochHead = 0;
+
+  bool _synced = false;
+  int64_t _offset = 0;     // _refLocal anındaki offset
+  double _drift = 0.0;     // offset eğimi (µs/µs)
+  int64_t _refLocal = 0;
+  int64_t _lastLocal = 0;
+  int64_t _bestDelay = 0;
+
+  // Epoch noktası ekle ve drift'i yeniden hesapla
+  void pushEpoch(int64_t local, int64_t offset) {
+    _epochs[_epochHead].local = local;
+    _epochs[_epochHead].offset = offset;
+    _epochHead = (_epochHead + 1) % EPOCHS;
+    if (_epochCount < EPOCHS) {
+      _epochCount++;
+    }
+    if (_epochCount < 2) {
+      return;
+    }
+
+    // En küçük kareler: offset = a + drift * local
+    int64_t refLocal = _epochs[0].local;
+    int64_t refOffset = _epochs[0].offset;
+    double mx = 0.0;
+    double my = 0.0;
+    for (uint8_t i = 0; i < _epochCount; i++) {
+      mx += (double)(_epochs[i].local - refLocal);
+      my += (double)(_epochs[i].offset - refOffset);
+    }
+    mx /= _epochCount;
+    my /= _epochCount;
+
+    double sxx = 0.0;
+    double sxy = 0.0;
+    int64_t minLocal = _epochs[0].local;
+    int64_t maxLocal = _epochs[0].local;
+    for (uint8_t i = 0; i < _epochCount; i++) {
+      double x = (double)(_epochs[i].local - refLocal) - mx;
+      double y = (double)(_epochs[i].offset - refOffset) - my;
+      sxx += x * x;
+      sxy += x * y;
+      if (_epochs[i].local < minLocal) {
+        minLocal = _epochs[i].local;
+      }
+      if (_epochs[i].local > maxLocal) {
+        maxLocal = _epochs[i].local;
+      }
+    }
+
+    // Taban çizgisi kısaysa drift güvenilmez, önceki değeri koru
+    if (maxLocal - minLocal >= MIN_DRIFT_SPAN_US && sxx > 0.0) {
+      double drift = sxy / sxx;
+      if (drift > MAX_DRIFT) {
+        drift = MAX_DRIFT;
+      }
+      if (drift < -MAX_DRIFT) {
+        drift = -MAX_DRIFT;
+      }
+      _drift = drift;
+    }
+  }
+
+  // Penceredeki aralıkların kesişiminden offset'i hesapla
+  void fit() {
+    if (_count < MIN_SAMPLES) {
+      _synced = false;
+      return;
+    }
+
+    // Her sınırı drift ile referans ana (son örnek) taşı; en sıkı üst ve alt sınırı bul
+    int64_t refLocal = _lastLocal;
+    int64_t hi = 0;
+    int64_t lo = 0;
+    for (uint8_t i = 0; i < _count; i++) {
+      const Sample& s = _samples[i];
+      int64_t shift = (int64_t)(_drift * (double)(refLocal - s.local));
+      if (i == 0 || s.hi + shift < hi) {
+        hi = s.hi + shift;
+      }
+      if (i == 0 || s.lo + shift > lo) {
+        lo = s.lo + shift;
+      }
+      if (i == 0 || s.hi - s.lo < _bestDelay) {
+        _bestDelay = s.hi - s.lo;
+      }
+    }
+
+    // Kesişim boşsa (drift hatası) orta nokta yine en iyi tahmindir
+    _offset = lo + (hi - lo) / 2;
+    _refLocal = refLocal;
+    _synced = true;
+  }
+};
+
+#endif // CLOCK_SYNC_H
@@ -2,11 +2,17 @@
 #define EVENT_TRANSPORT_H
 
 #include <Arduino.h>
+#include "Feedback.h"
+#include "SerialFrame.h"
+#include "JsonScan.h"
 #ifdef TRANSPORT_BLE
 #include <BLEDevice.h>
 #include <BLEServer.h>
 #include <BLEUtils.h>
 #include <BLE2902.h>
+#include <esp_timer.h>
+#include "ClockSync.h"
+#include "OtaService.h"
 #endif
 
 /* =========================================================
@@ -19,7 +25,8 @@ enum EventType : uint8_t {
   CONFIRM = 2,
   EVENT_CANCEL = 3,
   AI_PRESS = 4,
-  AI_RELEASE = 5
+  AI_RELEASE = 5,
+  SETTLE = 6          // Pozisyon dwell süresi boyunca değişmedi (kullanıcı bir öğede durdu)
 };
 
 struct Event {
@@ -27,6 +34,50 @@ struct Event {
   uint8_t mainIndex;  // opsiyonel
   uint8_t subIndex;   // opsiyonel
   uint32_t ts;        // millis() - debug, debounce, log korelasyonu için kritik
+  uint8_t velocity;   // Rotate event'lerinde dönüş hızı (adım/sn, 0 = tek adım / yavaş)
+};
+
+// SETTLE için varsayılan dwell süresi (ms). App {"settle":ms} yazarak değiştirebilir, 0 = kapalı
+static const uint16_t SETTLE_DWELL_MS_DEFAULT = 400;
+static const uint16_t SETTLE_DWELL_MS_MAX = 5000;
+
+// Tanılama komutları (app veya Serial'den gelir, loop'ta işlenir)
+enum DiagCommand : uint8_t {
+  DIAG_NONE = 0,
+  DIAG_STALL_QUERY,    // {"stall":1} / Serial '?': stall sayaçlarını gönder
+  DIAG_STALL_RESET,    // {"stall":0} / Serial '!': sayaçları sıfırla
+  DIAG_STALL_BUDGET,   // {"stall_budget":<us>}: tur bütçesini değiştir
+  DIAG_STATE_QUERY     // Serial CMD_STATE: pozisyon / buton durumunu gönder
+};
+
+struct DiagRequest {
+  DiagCommand cmd;
+  uint32_t value;
+};
+
+// Host'tan enjekte edilen girişler (Serial makine modu, test rig'i).
+// Fiziksel girişle aynı işleyiciye gider; rate limit ve debounce uygulanmaz.
+enum InjectKind : uint8_t {
+  INJECT_MAIN_STEP = 0,  // delta: ana encoder adımı (+1 / -1)
+  INJECT_SUB_STEP,       // delta: alt encoder adımı
+  INJECT_AI_PRESS,
+  INJECT_AI_RELEASE,
+  INJECT_CONFIRM,
+  INJECT_KIND_COUNT
+};
+
+struct InjectedInput {
+  InjectKind kind;
+  int8_t delta;
+};
+
+// DIAG_STATE_QUERY cevabı için loop'un anlık durumu
+struct DeviceState {
+  uint8_t mainIndex;
+  uint8_t subIndex;
+  bool aiPressed;
+  bool subSwPressed;
+  bool settlePending;
 };
 
 /* =========================================================
@@ -39,20 +90,61 @@ public:
   virtual void sendEvent(const Event& event) = 0;
   virtual void enablePairingMode() {}
   virtual void updateAdvertisingStatus() {}
+  // Bağlantı katmanı hazır olduğu an (micros), henüz hazır değilse 0
+  virtual uint32_t linkReadyMicros() const { return 0; }
+  // SETTLE event'i için dwell süresi (ms), 0 = SETTLE gönderilmez
+  virtual uint16_t settleDwellMs() const { return SETTLE_DWELL_MS_DEFAULT; }
+  // Bekleyen tanılama komutunu al (bir kez döner), yoksa false
+  virtual bool takeDiagRequest(DiagRequest* req) { return false; }
+  // Tanılama cevabını komutu gönderen tarafa ilet
+  virtual void sendDiag(const char* json, int len) {}
+  // DIAG_STATE_QUERY cevabını gönder
+  virtual void sendState(const DeviceState& state) {}
+  // Bekleyen enjekte girişi al (her çağrıda bir adım), yoksa false
+  virtual bool takeInjectedInput(InjectedInput* input) { return false; }
+  // Makine modu: çıktı ikili frame'lerdir, loop metin log'u basmamalı
+  virtual bool isMachineMode() const { return false; }
 };
 
 /* =========================================================
-   SERIAL EVENT TRANSPORT (Wokwi / Simülasyon)
-   ========================================================= */
+   SERIAL EVENT TRANSPORT (Wokwi / Simülasyon / Test Rig'i)
+   =========================================================
+
+   İki mod:
+   - Metin (varsayılan): Serial Monitor için okunabilir loglar,
+     '?' / '!' tek karakter tanılama komutları.
+   - Makine: Host CMD_HELLO frame'i gönderince açılır. Event'ler
+     COBS + CRC16 ikili frame olarak gider (SerialFrame.h), host
+     giriş enjekte edip durum sorgulayabilir. CMD_EXIT veya reset
+     ile metin moduna dönülür.
+
+   Frame'ler her iki modda da kabul edilir. Metin modunda tek
+   karakter komutları sadece frame dışında (senkron değilken)
+   yorumlanır; komut frame'leri kısa olduğundan COBS kod byte'ı
+   hiçbir zaman '?' veya '!' olmaz. */
 
 class SerialEventTransport : public IEventTransport {
 public:
-  SerialEventTransport(uint8_t ledPin) : _ledPin(ledPin) {
-    pinMode(_ledPin, OUTPUT);
-    digitalWrite(_ledPin, LOW);
-  }
+  SerialEventTransport(FeedbackEngine& feedback) : _feedback(feedback) {}
 
   void sendEvent(const Event& event) override {
+    _eventSeq++;
+
+    // LED tetikleme - Feedback engine arka planda oynatır (bekleme yok)
+    _feedback.play(FB_ACK);
+
+    if (_machineMode) {
+      uint8_t payload[12];
+      payload[0] = event.type;
+      payload[1] = event.mainIndex;
+      payload[2] = event.subIndex;
+      payload[3] = event.velocity;
+      SerialFrame::putU32(payload + 4, event.ts);
+      SerialFrame::putU32(payload + 8, _eventSeq);
+      writeFrame(FRAME_EVENT, 0, payload, sizeof(payload));
+      return;
+    }
+
     Serial.print("[DEBUG] SerialEventTransport.sendEvent çağrıldı: type=");
     Serial.print(event.type);
     Serial.print(" m=");
@@ -61,11 +153,6 @@ public:
     Serial.print(event.subIndex);
     Serial.print(" ts=");
     Serial.println(event.ts);
-    
-    // LED tetikleme - sendEvent() içinde
-    digitalWrite(_ledPin, HIGH);
-    delay(30);
-    digitalWrite(_ledPin, LOW);
 
     // Event type string'e çevir
     const char* typeStr = "";
@@ -76,6 +163,7 @@ public:
       case EVENT_CANCEL: typeStr = "CANCEL"; break;
       case AI_PRESS: typeStr = "AI_PRESS"; break;
       case AI_RELEASE: typeStr = "AI_RELEASE"; break;
+      case SETTLE: typeStr = "SETTLE"; break;
     }
 
     // Kompakt log formatı: [BLE] MAIN_ROTATE m=15 ts=12345
@@ -85,7 +173,8 @@ public:
     // mainIndex sadece ilgili event'lerde
     if (event.type == MAIN_ROTATE || event.type == SUB_ROTATE || 
         event.type == CONFIRM || event.type == EVENT_CANCEL || 
-        event.type == AI_PRESS || event.type == AI_RELEASE) {
+        event.type == AI_PRESS || event.type == AI_RELEASE ||
+        event.type == SETTLE) {
       Serial.print(" m=");
       Serial.print(event.mainIndex);
     }
@@ -93,10 +182,16 @@ public:
     // subIndex sadece ilgili event'lerde
     if (event.type == SUB_ROTATE || event.type == CONFIRM || 
         event.type == EVENT_CANCEL || event.type == AI_PRESS || 
-        event.type == AI_RELEASE) {
+        event.type == AI_RELEASE || event.type == SETTLE) {
       Serial.print(" s=");
       Serial.print(event.subIndex);
     }
+
+    // Dönüş hızı sadece rotate event'lerinde
+    if (event.type == MAIN_ROTATE || event.type == SUB_ROTATE) {
+      Serial.print(" v=");
+      Serial.print(event.velocity);
+    }
     
     Serial.print(" ts=");
     Serial.println(event.ts);
@@ -109,47 +204,251 @@ public:
     Serial.println("[DEBUG] SerialEventTransport.enablePairingMode çağrıldı");
     _pairingModeActive = true;
     _pairingModeStartTime = millis();
+    if (_linkReadyUs == 0) {
+      _linkReadyUs = micros();  // Serial için ek başlatma yok, hemen hazır
+    }
     Serial.println("[BLE] Pairing mode aktif - 30 saniye");
     Serial.println("[DEBUG] SerialEventTransport.enablePairingMode tamamlandı");
   }
+
+  uint32_t linkReadyMicros() const override {
+    return _linkReadyUs;
+  }
   
-  // Advertising durumunu kontrol et ve LED'i yanıp söndür
+  // Pairing süresini kontrol et ve LED pattern'ini güncelle
   void updateAdvertisingStatus() override {
-    static uint32_t lastBlinkTime = 0;
-    static bool ledState = false;
-    uint32_t now = millis();
-    
-    // Pairing mode kontrolü
-    if (_pairingModeActive) {
-      uint32_t elapsed = now - _pairingModeStartTime;
-      if (elapsed >= PAIRING_MODE_DURATION_MS) {
-        // 30 saniye geçti - pairing mode'u kapat
-        _pairingModeActive = false;
+    if (_pairingModeActive && millis() - _pairingModeStartTime >= PAIRING_MODE_DURATION_MS) {
+      // Süre doldu - pairing mode'u kapat
+      _pairingModeActive = false;
+      if (!_machineMode) {
         Serial.println("[BLE] Pairing mode sona erdi");
-      } else {
-        // Pairing mode aktif - LED hızlı yanıp sönsün (250ms)
-        if (now - lastBlinkTime >= 250) {
-          ledState = !ledState;
-          digitalWrite(_ledPin, ledState ? HIGH : LOW);
-          lastBlinkTime = now;
-        }
-        return; // Pairing mode'da normal advertising status'u atla
       }
     }
-    
     // Normal durumda LED kapalı (Serial transport için)
-    if (ledState) {
-      digitalWrite(_ledPin, LOW);
-      ledState = false;
+    _feedback.setBackground(_pairingModeActive ? FB_PAIRING : FB_NONE);
+  }
+
+  uint16_t settleDwellMs() const override {
+    return _settleDwellMs;
+  }
+
+  bool isMachineMode() const override {
+    return _machineMode;
+  }
+
+  // Metin modu: '?' stall sorgusu, '!' sıfırla. Makine modu: CMD_STATE / CMD_STALL frame'leri
+  bool takeDiagRequest(DiagRequest* req) override {
+    pollInput();
+    if (!_diagPending) {
+      return false;
     }
-    lastBlinkTime = now;
+    _diagPending = false;
+    *req = _diagReq;
+    return true;
+  }
+
+  // Makine modunda TEXT frame, metin modunda main zaten [STALL] stats basar
+  void sendDiag(const char* json, int len) override {
+    if (_machineMode && len > 0) {
+      writeFrame(FRAME_TEXT, _diagSeq, (const uint8_t*)json, (size_t)len);
+    }
+  }
+
+  void sendState(const DeviceState& state) override {
+    if (!_machineMode) {
+      Serial.print("[STATE] m=");
+      Serial.print(state.mainIndex);
+      Serial.print(" s=");
+      Serial.print(state.subIndex);
+      Serial.print(" ai=");
+      Serial.print(state.aiPressed ? 1 : 0);
+      Serial.print(" sw=");
+      Serial.print(state.subSwPressed ? 1 : 0);
+      Serial.print(" settle=");
+      Serial.print(state.settlePending ? 1 : 0);
+      Serial.print(" seq=");
+      Serial.println(_eventSeq);
+      return;
+    }
+    uint8_t payload[21];
+    payload[0] = state.mainIndex;
+    payload[1] = state.subIndex;
+    payload[2] = (state.aiPressed ? STATE_FLAG_AI : 0) |
+                 (state.subSwPressed ? STATE_FLAG_SUB_SW : 0) |
+                 (state.settlePending ? STATE_FLAG_SETTLE_PENDING : 0);
+    SerialFrame::putU16(payload + 3, _settleDwellMs);
+    SerialFrame::putU32(payload + 5, millis());
+    SerialFrame::putU32(payload + 9, _eventSeq);
+    SerialFrame::putU32(payload + 13, _reader.errors());
+    SerialFrame::putU32(payload + 17, _txDropped);
+    writeFrame(FRAME_STATE, _diagSeq, payload, sizeof(payload));
+  }
+
+  // Kuyruktaki enjekte girişten bir adım ver. Event frame'i için TX'te yer
+  // yoksa bekletir (host yavaşsa event atılmaz, girişler kuyrukta kalır)
+  bool takeInjectedInput(InjectedInput* input) override {
+    pollInput();
+    if (_injectCount == 0) {
+      return false;
+    }
+    if (_machineMode && Serial.availableForWrite() < (int)EVENT_FRAME_MAX) {
+      return false;
+    }
+    InjectEntry& e = _injectQueue[_injectHead];
+    input->kind = (InjectKind)e.kind;
+    input->delta = e.delta;
+    if (--e.remaining == 0) {
+      _injectHead = (_injectHead + 1) % INJECT_QUEUE_SIZE;
+      _injectCount--;
+    }
+    return true;
   }
 
 private:
-  uint8_t _ledPin;
+  struct InjectEntry {
+    uint8_t kind;
+    int8_t delta;
+    uint8_t remaining;  // Tekrar sayısı (CMD_INJECT count)
+  };
+
+  static const uint32_t PAIRING_MODE_DURATION_MS = 15000; // 15 saniye
+  static const uint8_t INJECT_QUEUE_SIZE = 32;
+  static const uint16_t RX_BYTES_PER_POLL = 256;  // Tek çağrıda okunacak en fazla byte
+  static const size_t EVENT_FRAME_MAX = 24;       // 12 byte payload'lı kodlanmış frame üst sınırı
+
+  FeedbackEngine& _feedback;
   bool _pairingModeActive = false;
   uint32_t _pairingModeStartTime = 0;
-  static const uint32_t PAIRING_MODE_DURATION_MS = 15000; // 15 saniye
+  uint32_t _linkReadyUs = 0;
+  uint16_t _settleDwellMs = SETTLE_DWELL_MS_DEFAULT;
+
+  bool _machineMode = false;
+  uint32_t _eventSeq = 0;     // Gönderilen event sayısı (host kayıp tespiti için)
+  uint32_t _txDropped = 0;    // TX'te yer olmadığı için atılan event frame'leri
+  FrameReader _reader;
+  uint8_t _txBuf[FRAME_MAX_ENCODED];
+
+  bool _diagPending = false;
+  DiagRequest _diagReq = { DIAG_NONE, 0 };
+  uint8_t _diagSeq = 0;       // Cevap frame'inde dönecek komut seq'i
+
+  InjectEntry _injectQueue[INJECT_QUEUE_SIZE];
+  uint8_t _injectHead = 0;
+  uint8_t _injectCount = 0;
+
+  // Serial'deki byte'ları işle (loop'u bloklamamak için çağrı başına sınırlı)
+  void pollInput() {
+    for (uint16_t i = 0; i < RX_BYTES_PER_POLL && Serial.available() > 0; i++) {
+      int c = Serial.read();
+      if (c < 0) {
+        break;
+      }
+      if (!_machineMode && !_reader.synced()) {
+        if (c == '?' || c == '!') {
+          queueDiag(c == '?' ? DIAG_STALL_QUERY : DIAG_STALL_RESET, 0, 0);
+          continue;
+        }
+      }
+      bool hadData = _reader.pending() > 0;
+      if (_reader.push((uint8_t)c)) {
+        handleFrame();
+      }
+      // Metin modunda her frame kendi baştaki 0x00'ı ile gelir; arada yazılan '?' kaybolmasın
+      if (c == 0 && hadData && !_machineMode) {
+        _reader.unsync();
+      }
+    }
+  }
+
+  void handleFrame() {
+    uint8_t type = _reader.type();
+    uint8_t seq = _reader.seq();
+    const uint8_t* p = _reader.payload();
+    size_t len = _reader.payloadLen();
+
+    switch (type) {
+      case CMD_HELLO: {
+        _machineMode = true;
+        uint8_t payload[3];
+        payload[0] = SERIAL_PROTOCOL_VERSION;
+        SerialFrame::putU16(payload + 1, (uint16_t)FRAME_MAX_PAYLOAD);
+        writeFrame(FRAME_HELLO, seq, payload, sizeof(payload));
+        break;
+      }
+      case CMD_EXIT:
+        sendAck(type, seq, FRAME_OK);
+        _machineMode = false;
+        Serial.println("[SERIAL] Metin moduna dönüldü");
+        break;
+      case CMD_INJECT:
+        if (len < 3 || p[0] >= INJECT_KIND_COUNT || p[2] == 0) {
+          sendAck(type, seq, FRAME_ERR_BAD_ARG);
+        } else if (_injectCount >= INJECT_QUEUE_SIZE) {
+          sendAck(type, seq, FRAME_ERR_QUEUE_FULL);
+        } else {
+          InjectEntry& e = _injectQueue[(_injectHead + _injectCount) % INJECT_QUEUE_SIZE];
+          e.kind = p[0];
+          e.delta = (int8_t)p[1];
+          e.remaining = p[2];
+          _injectCount++;
+        }
+        break;
+      case CMD_STATE:
+        if (!queueDiag(DIAG_STATE_QUERY, 0, seq)) {
+          sendAck(type, seq, FRAME_ERR_QUEUE_FULL);
+        }
+        break;
+      case CMD_STALL:
+        if (!queueDiag((len > 0 && p[0] == 0) ? DIAG_STALL_RESET : DIAG_STALL_QUERY, 0, seq)) {
+          sendAck(type, seq, FRAME_ERR_QUEUE_FULL);
+        }
+        break;
+      case CMD_SETTLE: {
+        uint16_t ms = len >= 2 ? SerialFrame::getU16(p) : 0xFFFF;
+        if (ms > SETTLE_DWELL_MS_MAX) {
+          sendAck(type, seq, FRAME_ERR_BAD_ARG);
+        } else {
+          _settleDwellMs = ms;
+          sendAck(type, seq, FRAME_OK);
+        }
+        break;
+      }
+      default:
+        sendAck(type, seq, FRAME_ERR_UNKNOWN);
+        break;
+    }
+  }
+
+  // Tek tanılama yuvası: önceki işlenmeden yenisi gelirse reddedilir
+  bool queueDiag(DiagCommand cmd, uint32_t value, uint8_t seq) {
+    if (_diagPending) {
+      return false;
+    }
+    _diagReq.cmd = cmd;
+    _diagReq.value = value;
+    _diagSeq = seq;
+    _diagPending = true;
+    return true;
+  }
+
+  void sendAck(uint8_t cmd, uint8_t seq, FrameStatus status) {
+    uint8_t payload[2] = { cmd, status };
+    writeFrame(FRAME_ACK, seq, payload, sizeof(payload));
+  }
+
+  // Event frame'leri TX dolunca beklemez, atılır ve sayılır; cevaplar her zaman yazılır
+  bool writeFrame(uint8_t type, uint8_t seq, const uint8_t* payload, size_t len) {
+    size_t n = SerialFrame::build(type, seq, payload, len, _txBuf);
+    if (n == 0) {
+      return false;
+    }
+    if (type == FRAME_EVENT && Serial.availableForWrite() < (int)n) {
+      _txDropped++;
+      return false;
+    }
+    Serial.write(_txBuf, n);
+    return true;
+  }
 };
 
 /* =========================================================
@@ -162,11 +461,19 @@ private:
 #define SERVICE_UUID        "12345678-1234-1234-1234-123456789abc"
 #define CHARACTERISTIC_UUID "12345678-1234-1234-1234-123456789abd"
 
+// Aynı anda bağlanabilecek telefon/saat sayısı (Bluedroid varsayılanı 3)
+#define BLE_MAX_CONNECTIONS 3
+
+// Bağlantı kalitesi: yerel ATT MTU üst sınırı (app 512 ister), LL data length (DLE) ve
+// aynı loop turunda üretilen payload'ları tek notify'da birleştiren batch buffer'ı
+#define BLE_LOCAL_MTU 517
+#define BLE_DATA_LEN_MAX 251
+#define BLE_TX_BATCH_MAX 512
+
 class BLEEventTransport : public IEventTransport {
 public:
-  BLEEventTransport(uint8_t ledPin) : _ledPin(ledPin), _deviceConnected(false), _oldDeviceConnected(false), _pairingModeActive(false), _pairingModeStartTime(0) {
-    pinMode(_ledPin, OUTPUT);
-    digitalWrite(_ledPin, LOW);
+  BLEEventTransport(FeedbackEngine& feedback) : _feedback(feedback), _oldConnectedCount(0), _pairingModeActive(false), _pairingModeStartTime(0) {
+    _instance = this;
     
     // BLE başlat (constructor'da başlatma, enableBLE() ile kontrol edilebilir)
     // İlk başta kapalı başlat, AI butonuna 5 saniye basılı tutarak açılacak
@@ -175,57 +482,260 @@ public:
     Serial.println("[BLE] Bluetooth kapalı başlatıldı. AI butonuna 5 saniye basılı tutarak açabilirsiniz.");
   }
 
+  // Event'i bir kez JSON'a çevir ve notify'a abone olan tüm bağlantılara gönder
   void sendEvent(const Event& event) override {
-    // LED tetikleme
-    digitalWrite(_ledPin, HIGH);
-    delay(30);
-    digitalWrite(_ledPin, LOW);
-
-    // Event'i JSON formatında hazırla (güvenli string oluşturma)
-    char jsonBuffer[128];
-    snprintf(jsonBuffer, sizeof(jsonBuffer), 
-             "{\"type\":%d,\"mainIndex\":%d,\"subIndex\":%d,\"ts\":%lu}\n",
-             event.type, event.mainIndex, event.subIndex, event.ts);
-    String json = String(jsonBuffer);
-    
-    // Gönderim öncesi delay (paket bütünlüğü için - MTU değişikliği için zaman tanı)
-    delay(10);
-    
-    // BLE'ye gönder (eğer bağlıysa)
-    if (_deviceConnected) {
-      // JSON'un tamamını tek seferde gönder
-      _pCharacteristic->setValue(json.c_str());
-      _pCharacteristic->notify();
-      // Gönderim sonrası delay (paket bütünlüğü için - bir sonraki event için hazır ol)
-      delay(10);
+    // LED tetikleme - Feedback engine arka planda oynatır (bekleme yok)
+    _feedback.play(FB_ACK);
+
+    // Event gövdesi tek sefer oluşturulur (tüm bağlantılar için ortak)
+    _eventSeq++;
+    char body[96];
+    int bodyLen = snprintf(body, sizeof(body),
+             "{\"type\":%d,\"mainIndex\":%d,\"subIndex\":%d,\"ts\":%lu,\"seq\":%lu",
+             event.type, event.mainIndex, event.subIndex, event.ts, (unsigned long)_eventSeq);
+    if (event.type == MAIN_ROTATE || event.type == SUB_ROTATE) {
+      bodyLen += snprintf(body + bodyLen, sizeof(body) - bodyLen, ",\"v\":%u", event.velocity);
+    }
+
+    // Read-polling yapan istemciler için characteristic değeri (telefon zamanı olmadan)
+    snprintf(_lastValue, sizeof(_lastValue), "%s}\n", body);
+    if (isBLEEnabled()) {
+      _pCharacteristic->setValue(_lastValue);
+    }
+
+    // Fan-out: her bağlantıya sadece kendi saat senkronu eki (pts/sd) eklenir
+    uint32_t fanoutStart = micros();
+    uint8_t peers = 0;
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      BLEConnection& c = _connections[i];
+      if (!c.active || !c.notify) {
+        continue;
+      }
+      char payload[160];
+      memcpy(payload, body, bodyLen);
+      int len = bodyLen;
+      // pts: Event anı (telefon elapsedRealtime, ms), sd: Cihaz içi gönderim gecikmesi (ms)
+      if (c.clock.isSynced()) {
+        int64_t nowUs = esp_timer_get_time();
+        int64_t pts = c.clock.toRemote((int64_t)event.ts * 1000) / 1000;
+        len += snprintf(payload + len, sizeof(payload) - len,
+                        ",\"pts\":%lld,\"sd\":%lu",
+                        (long long)pts, (unsigned long)(nowUs / 1000 - event.ts));
+      }
+      len += snprintf(payload + len, sizeof(payload) - len, "}\n");
+      if (queuePeer(c, payload, len)) {
+        c.lastSeq = _eventSeq;
+      }
+      peers++;
+    }
+    uint32_t fanoutUs = micros() - fanoutStart;
+    if (peers > 0) {
+      _fanout.record(peers, fanoutUs);
     }
     
     // Serial'e de logla (debug için - tam JSON)
     Serial.print("[BLE] ");
-    Serial.print(json);
+    Serial.print(_lastValue);
   }
   
-  void setDeviceConnected(bool connected) {
-    _deviceConnected = connected;
+  // Bağlı en az bir cihaz var mı?
+  bool isConnected() const {
+    return _connectedCount > 0;
+  }
+
+  uint8_t connectedCount() const {
+    return _connectedCount;
+  }
+
+  // Characteristic'e yazılan ping'i kaydet (BLE task'ından çağrılır)
+  // Format: {"sync":<seq>,"t1":<µs>,"ps":<önceki seq>,"p4":<önceki t4 µs>}
+  // t1/p4 telefon saatinde (elapsedRealtimeNanos / 1000). Diğer yazımlar
+  // (ör. polling için 0x01) yok sayılır. Her bağlantının saati ayrı tutulur.
+  void onPing(uint16_t connId, const char* data, int64_t t2) {
+    int64_t seq, t1;
+    if (data[0] != '{' || !jsonInt64(data, "\"sync\":", &seq) || !jsonInt64(data, "\"t1\":", &t1)) {
+      return;
+    }
+    int64_t ps = -1;
+    int64_t p4 = 0;
+    bool hasPrev = jsonInt64(data, "\"ps\":", &ps) && jsonInt64(data, "\"p4\":", &p4);
+
+    portENTER_CRITICAL(&_connMux);
+    BLEConnection* c = findConnection(connId);
+    if (c != nullptr) {
+      // Önceki turun t4'ü geldiyse örneği tamamla
+      if (hasPrev && c->lastPong.valid && c->lastPong.seq == ps) {
+        c->completed = c->lastPong;
+        c->completed.t4 = p4;
+        c->lastPong.valid = false;
+      }
+      c->pendingPing.seq = seq;
+      c->pendingPing.t1 = t1;
+      c->pendingPing.t2 = t2;
+      c->pendingPing.valid = true;
+    }
+    portEXIT_CRITICAL(&_connMux);
+  }
+
+  // App'in SETTLE dwell ayarı: {"settle":<ms>} (0 = kapalı). Tüm bağlantılar için ortak
+  void onSettleConfig(const char* data) {
+    int64_t ms;
+    if (data[0] != '{' || !jsonInt64(data, "\"settle\":", &ms) || ms < 0) {
+      return;
+    }
+    _settleDwellMs = ms > SETTLE_DWELL_MS_MAX ? SETTLE_DWELL_MS_MAX : (uint16_t)ms;
+  }
+
+  uint16_t settleDwellMs() const override {
+    return _settleDwellMs;
+  }
+
+  // Tanılama komutu: {"stall":1} sorgu, {"stall":0} sıfırla, {"stall_budget":<us>}
+  // Cevap sadece komutu yazan bağlantıya gider (BLE task'ından çağrılır)
+  void onDiag(uint16_t connId, const char* data) {
+    int64_t value;
+    DiagRequest req = { DIAG_NONE, 0 };
+    if (data[0] != '{') {
+      return;
+    }
+    if (jsonInt64(data, "\"stall\":", &value)) {
+      req.cmd = value == 0 ? DIAG_STALL_RESET : DIAG_STALL_QUERY;
+    } else if (jsonInt64(data, "\"stall_budget\":", &value) && value > 0) {
+      req.cmd = DIAG_STALL_BUDGET;
+      req.value = (uint32_t)value;
+    } else {
+      return;
+    }
+    portENTER_CRITICAL(&_connMux);
+    _diagReq = req;
+    _diagConnId = connId;
+    _diagPending = true;
+    portEXIT_CRITICAL(&_connMux);
+  }
+
+  bool takeDiagRequest(DiagRequest* req) override {
+    if (!_diagPending) {
+      return false;
+    }
+    portENTER_CRITICAL(&_connMux);
+    *req = _diagReq;
+    _diagReplyConnId = _diagConnId;
+    _diagPending = false;
+    portEXIT_CRITICAL(&_connMux);
+    return true;
+  }
+
+  void sendDiag(const char* json, int len) override {
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      BLEConnection& c = _connections[i];
+      if (c.active && c.notify && c.connId == _diagReplyConnId) {
+        notifyPeer(c, json, len);
+        return;
+      }
+    }
+  }
+
+  // Bekleyen ping'lere pong gönder ve tamamlanan turları estimator'a ekle (loop'tan)
+  void handleClockSync() {
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      BLEConnection& c = _connections[i];
+      SyncRound ping;
+      SyncRound done;
+      portENTER_CRITICAL(&_connMux);
+      bool active = c.active;
+      ping = c.pendingPing;
+      done = c.completed;
+      c.pendingPing.valid = false;
+      c.completed.valid = false;
+      portEXIT_CRITICAL(&_connMux);
+
+      if (!active) {
+        continue;
+      }
+      if (done.valid) {
+        c.clock.addSample(done.t1, done.t2, done.t3, done.t4);
+      }
+      if (!ping.valid) {
+        continue;
+      }
+
+      // Pong sadece ping'i gönderen bağlantıya gider
+      char pong[96];
+      ping.t3 = esp_timer_get_time();
+      int len = snprintf(pong, sizeof(pong), "{\"pong\":%lld,\"t2\":%lld,\"t3\":%lld}\n",
+                         (long long)ping.seq, (long long)ping.t2, (long long)ping.t3);
+      notifyPeer(c, pong, len);
+
+      portENTER_CRITICAL(&_connMux);
+      c.lastPong = ping;
+      portEXIT_CRITICAL(&_connMux);
+    }
   }
   
   void handleConnection() {
-    if (!_deviceConnected && _oldDeviceConnected) {
-      // Bağlantı kesildi
-      delay(500);
-      BLEDevice::startAdvertising();
-      Serial.println("[BLE] Bağlantı kesildi, yeniden advertising başlatıldı");
-      _oldDeviceConnected = _deviceConnected;
+    // ble_start task'ı kurulumu bitirmeden server / characteristic'e dokunma
+    if (!isBLEEnabled()) {
+      _oldConnectedCount = _connectedCount;
+      return;
+    }
+
+    // Yeni bağlantıların loop tarafındaki durumunu sıfırla (saat senkronu, sayaçlar)
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      BLEConnection& c = _connections[i];
+      if (c.active && c.fresh) {
+        c.fresh = false;
+        c.clock.reset();
+        c.lastSeq = _eventSeq;
+        c.notifySent = 0;
+        c.notifyFailed = 0;
+        c.bytesSent = 0;
+        c.queued = 0;
+        c.txLen = 0;
+        c.txDropped = 0;
+        c.dropBurst = 0;
+      }
+      if (c.active && c.linkChanged) {
+        printLink(c);
+      }
+    }
+
+    handleClockSync();
+
+    uint8_t count = _connectedCount;
+    if (count < _oldConnectedCount) {
+      // Bağlantı kesildi - advertising'i bloklamadan biraz sonra yeniden başlat
+      _advRestartAt = millis() + ADV_RESTART_DELAY_MS;
+      _advRestartPending = true;
+      Serial.print("[BLE] Bağlantı kesildi, bağlı cihaz: ");
+      Serial.println(count);
+      printStats(Serial);
     }
     
-    if (_deviceConnected && !_oldDeviceConnected) {
+    if (count > _oldConnectedCount) {
       // Yeni bağlantı - pairing mode'u kapat
       _pairingModeActive = false;
       // LED'i söndür
-      digitalWrite(_ledPin, LOW);
-      Serial.println("[BLE] Cihaz bağlandı - Pairing mode sona erdi - LED söndürüldü");
-      _oldDeviceConnected = _deviceConnected;
+      _feedback.setBackground(FB_NONE);
+      Serial.print("[BLE] Cihaz bağlandı - Pairing mode sona erdi - LED söndürüldü, bağlı cihaz: ");
+      Serial.println(count);
+      // Bluedroid bağlantıda advertising'i durdurur; boş slot varsa diğer cihazlar için devam et
+      if (count < BLE_MAX_CONNECTIONS) {
+        _advRestartAt = millis();
+        _advRestartPending = true;
+      }
     }
+    _oldConnectedCount = count;
+
+    if (_advRestartPending && (int32_t)(millis() - _advRestartAt) >= 0) {
+      _advRestartPending = false;
+      if (isBLEEnabled() && _connectedCount < BLE_MAX_CONNECTIONS) {
+        BLEDevice::startAdvertising();
+        Serial.println("[BLE] Yeniden advertising başlatıldı");
+      }
+    }
+
+    // Bu turda biriken event'leri gönder (bağlantı başına tek notify)
+    flushPeers();
   }
   
   // Bluetooth'u aç
@@ -234,6 +744,20 @@ public:
       Serial.println("[BLE] Bluetooth başlatılıyor...");
       BLEDevice::init("GormeEngellilerKumanda");
       Serial.println("[BLE] Device Name: GormeEngellilerKumanda");
+      // Bağlantı bazında MTU ve CCCD (notify aboneliği) takibi için
+      BLEDevice::setCustomGattsHandler(&BLEEventTransport::gattsHandler);
+      // PHY / data length sonuçları için
+      BLEDevice::setCustomGapHandler(&BLEEventTransport::gapHandler);
+      // Telefonun MTU isteği buna kadar kabul edilir (app 512 ister)
+      BLEDevice::setMTU(BLE_LOCAL_MTU);
+#if defined(CONFIG_BT_BLE_50_FEATURES_SUPPORTED)
+      // Yeni bağlantılar için 2M PHY tercih et (desteklemeyen telefon 1M'de kalır)
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+      esp_ble_gap_set_preferred_default_phy(ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_2M_PREF_MASK);
+#else
+      esp_ble_gap_set_prefered_default_phy(ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_2M_PREF_MASK);
+#endif
+#endif
       
       // BLE Server oluştur
       _pServer = BLEDevice::createServer();
@@ -255,8 +779,13 @@ public:
       );
       Serial.print("[BLE] Characteristic UUID: ");
       Serial.println(CHARACTERISTIC_UUID);
+      _pCharacteristic->setCallbacks(new MyCharacteristicCallbacks(this));
       
-      _pCharacteristic->addDescriptor(new BLE2902());
+      _pCccd = new BLE2902();
+      _pCharacteristic->addDescriptor(_pCccd);
+
+      // OTA control/data characteristic'leri (aynı servis)
+      _ota.attach(_pServer, _pService);
       _pService->start();
       Serial.println("[BLE] Service başlatıldı");
       Serial.println("[BLE] Bluetooth açıldı");
@@ -279,84 +808,546 @@ public:
   // Bluetooth'u kapat
   void disableBLE() {
     if (BLEDevice::getInitialized()) {
+      _bleReady = false;  // Önce loop tarafını kapat, sonra stack'i sök
       BLEDevice::deinit(true);
+      portENTER_CRITICAL(&_connMux);
+      for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        _connections[i].active = false;
+      }
+      _connectedCount = 0;
+      _dleInFlight = -1;
+      portEXIT_CRITICAL(&_connMux);
       Serial.println("[BLE] Bluetooth kapatıldı");
     }
   }
   
-  // Bluetooth açık mı kontrol et
+  // Bluetooth açık ve kurulumu tamamlanmış mı? (loop tarafındaki tüm BLE yolları buna bakar)
+  // BLEDevice::getInitialized() init'in başında true olur; server henüz yokken yetmez
   bool isBLEEnabled() {
-    return BLEDevice::getInitialized();
+    return _bleReady;
   }
   
   // Pairing mode'u başlat (30 saniyelik pairing window)
+  // BLE stack'i ayrı bir task'ta başlatılır: BLEDevice::init + GATT server
+  // kurulumu yüzlerce ms sürer ve bu sırada loop() input okumaya devam etmeli.
   void enablePairingMode() {
     Serial.println("[DEBUG] BLEEventTransport.enablePairingMode çağrıldı");
-    enableBLE(); // BLE'yi aç
-    Serial.println("[DEBUG] BLE açıldı");
     _pairingModeActive = true;
     _pairingModeStartTime = millis();
+    if (!_bleStarting && !isBLEEnabled()) {
+      _bleStarting = true;
+      _linkReadyUs = 0;
+      // Core 0: BLE controller task'ları ile aynı core, loop() core 1'de kalır
+      if (xTaskCreatePinnedToCore(bleStartTask, "ble_start", BLE_START_TASK_STACK,
+                                  this, 1, nullptr, 0) != pdPASS) {
+        // Task oluşturulamadı - senkron başlatmaya geri dön
+        _bleStarting = false;
+        enableBLE();
+        _linkReadyUs = micros();
+        _bleReady = true;
+      }
+    } else if (isBLEEnabled()) {
+      enableBLE(); // Zaten açık - advertising'i yeniden başlat
+    }
     Serial.println("[BLE] Pairing mode aktif - 30 saniye");
     Serial.println("[DEBUG] BLEEventTransport.enablePairingMode tamamlandı");
   }
+
+  // BLE hazır olduğu an (micros), başlatma sürüyorsa 0
+  uint32_t linkReadyMicros() const override {
+    return _linkReadyUs;
+  }
   
-  // Advertising durumunu kontrol et ve LED'i yanıp söndür (bağlantı yoksa)
+  // Advertising durumunu kontrol et ve LED pattern'ini seç (bağlantı yoksa yanıp söner)
+  // Yanıp söndürme Feedback engine'de; burada sadece durum değişince pattern değişir
   void updateAdvertisingStatus() {
-    static uint32_t lastBlinkTime = 0;
-    static bool ledState = false;
-    uint32_t now = millis();
-    
-    // Pairing mode kontrolü
-    if (_pairingModeActive) {
-      uint32_t elapsed = now - _pairingModeStartTime;
-      if (elapsed >= PAIRING_MODE_DURATION_MS) {
-        // 30 saniye geçti - pairing mode'u kapat
-        _pairingModeActive = false;
-        // LED'i söndür
-        digitalWrite(_ledPin, LOW);
-        ledState = false;
-        if (!_deviceConnected) {
-          disableBLE(); // Bağlantı yoksa BLE'yi kapat
-        }
-        Serial.println("[BLE] Pairing mode sona erdi - LED söndürüldü");
-      } else {
-        // Pairing mode aktif - LED hızlı yanıp sönsün (250ms)
-        if (now - lastBlinkTime >= 250) {
-          ledState = !ledState;
-          digitalWrite(_ledPin, ledState ? HIGH : LOW);
-          lastBlinkTime = now;
-        }
-        return; // Pairing mode'da normal advertising status'u atla
+    // Süre doldu - pairing mode'u kapat. ble_start task'ı hâlâ çalışıyorsa kapatma
+    // ertelenir: pairing mode açık kalır ve task bitince sonraki turda BLE kapatılır
+    if (_pairingModeActive && !_bleStarting &&
+        millis() - _pairingModeStartTime >= PAIRING_MODE_DURATION_MS) {
+      _pairingModeActive = false;
+      if (!isConnected()) {
+        disableBLE(); // Bağlantı yoksa BLE'yi kapat
+        _feedback.play(FB_ERROR);  // Kullanıcıya eşleşme olmadığını bildir
       }
+      Serial.println("[BLE] Pairing mode sona erdi - LED söndürüldü");
     }
-    
-    // Normal advertising status (bağlantı yoksa ve BLE açıksa LED'i yanıp söndür)
-    if (!_deviceConnected && isBLEEnabled()) {
-      if (now - lastBlinkTime >= 500) {  // 500ms'de bir yanıp sönsün
-        ledState = !ledState;
-        digitalWrite(_ledPin, ledState ? HIGH : LOW);
-        lastBlinkTime = now;
-      }
+
+    if (_pairingModeActive) {
+      _feedback.setBackground(FB_PAIRING);      // Hızlı yanıp sönme (250ms)
+    } else if (!isConnected() && isBLEEnabled()) {
+      _feedback.setBackground(FB_ADVERTISING);  // Yavaş yanıp sönme (500ms)
     } else {
-      // Bağlantı varsa veya BLE kapalıysa LED'i söndür
-      if (ledState) {
-        digitalWrite(_ledPin, LOW);
-        ledState = false;
+      _feedback.setBackground(FB_NONE);         // Bağlı veya BLE kapalı
+    }
+  }
+
+  // Bağlantı başına durum ve fan-out maliyeti
+  // Airtime tahmini 1M PHY içindir: paket başına (payload + 17 byte ek yük) * 8µs + 150µs IFS
+  void printStats(Print& out) {
+    out.print("[BLE] stats peers=");
+    out.print(_connectedCount);
+    out.print(" events=");
+    out.print((unsigned long)_eventSeq);
+    out.print(" fanout_avg_us=");
+    out.print(_fanout.count > 0 ? (unsigned long)(_fanout.totalUs / _fanout.count) : 0UL);
+    out.print(" fanout_max_us=");
+    out.print((unsigned long)_fanout.maxUs);
+    out.print(" us_per_peer=");
+    out.println(_fanout.peerEvents > 0 ? (unsigned long)(_fanout.totalUs / _fanout.peerEvents) : 0UL);
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      const BLEConnection& c = _connections[i];
+      if (!c.active) {
+        continue;
       }
-      lastBlinkTime = now;
+      out.print("[BLE] peer conn=");
+      out.print(c.connId);
+      out.print(" mtu=");
+      out.print(c.mtu);
+      out.print(" phy=");
+      out.print(phyName(c.txPhy));
+      out.print(" dle=");
+      out.print(c.dataLen);
+      out.print(" notify=");
+      out.print(c.notify ? 1 : 0);
+      out.print(" seq=");
+      out.print((unsigned long)c.lastSeq);
+      out.print(" queued=");
+      out.print((unsigned long)c.queued);
+      out.print(" sent=");
+      out.print((unsigned long)c.notifySent);
+      out.print(" failed=");
+      out.print((unsigned long)c.notifyFailed);
+      out.print(" dropped=");
+      out.print((unsigned long)c.txDropped);
+      out.print(" bytes=");
+      out.print((unsigned long)c.bytesSent);
+      out.print(" airtime_us=");
+      out.print((unsigned long)((c.bytesSent + 17UL * c.notifySent) * 8UL + 150UL * c.notifySent));
+      out.print(" synced=");
+      out.println(c.clock.isSynced() ? 1 : 0);
     }
   }
 
 private:
-  uint8_t _ledPin;
-  BLEServer* _pServer;
-  BLEService* _pService;
-  BLECharacteristic* _pCharacteristic;
-  bool _deviceConnected;
-  bool _oldDeviceConnected;
+  // Saat senkronu (ping/pong turları)
+  struct SyncRound {
+    bool valid = false;
+    int64_t seq = 0;
+    int64_t t1 = 0, t2 = 0, t3 = 0, t4 = 0;
+  };
+
+  // Bağlı bir merkezi cihazın (telefon, saat, tablet) durumu
+  // active/connId/mtu/notify/ping alanları BLE task'ında (mux ile), diğerleri loop'ta güncellenir
+  struct BLEConnection {
+    bool active = false;
+    bool fresh = false;        // Yeni bağlandı, loop tarafı henüz sıfırlamadı
+    uint16_t connId = 0;
+    uint16_t mtu = 23;         // ATT MTU (varsayılan 23)
+    bool notify = false;       // CCCD ile notify'a abone mi?
+    uint32_t lastSeq = 0;      // Bu bağlantıya iletilen son event seq
+    uint32_t notifySent = 0;   // Gönderilen notify paketi
+    uint32_t notifyFailed = 0; // Stack'in kabul etmediği notify (veri kuyrukta kalır, tekrar denenir)
+    uint32_t txDropped = 0;    // Kuyruk dolu olduğu için atılan payload
+    uint16_t dropBurst = 0;    // Kuyruk boşalana kadar atılanlar (boşalınca loglanır)
+    uint32_t bytesSent = 0;
+    esp_bd_addr_t bda = {0};   // Karşı taraf adresi (GAP olaylarını bağlantıya eşlemek için)
+    uint8_t txPhy = 1;         // 1 = 1M, 2 = 2M, 3 = Coded
+    uint8_t rxPhy = 1;
+    uint16_t dataLen = 27;     // LL TX payload (DLE yoksa 27)
+    bool dlePending = false;   // Data length isteği sırada (aynı anda tek istek gider)
+    bool linkChanged = false;  // MTU/PHY/DLE değişti, loop loglayacak
+    volatile bool congested = false;  // L2CAP tıkanık: kuyruk tıkanıklık bitene kadar bekletilir
+    uint32_t queued = 0;       // Kuyruğa alınan payload (notifySent'ten fazlası birleştirilmiştir)
+    uint16_t txLen = 0;
+    char tx[BLE_TX_BATCH_MAX]; // Henüz gönderilmemiş veri (satır sonu ile ayrılmış JSON)
+    ClockSync clock;
+    SyncRound pendingPing;     // Cevap bekleyen ping (t1, t2)
+    SyncRound lastPong;        // Gönderilen son pong (t4 bekleniyor)
+    SyncRound completed;       // t4'ü gelmiş, estimator'a eklenecek tur
+  };
+
+  // Fan-out maliyeti (loop içinde sendEvent başına)
+  struct FanoutStats {
+    uint32_t count = 0;        // En az bir alıcısı olan event sayısı
+    uint32_t peerEvents = 0;   // Toplam (event x alıcı)
+    uint64_t totalUs = 0;
+    uint32_t maxUs = 0;
+    void record(uint8_t peers, uint32_t us) {
+      count++;
+      peerEvents += peers;
+      totalUs += us;
+      if (us > maxUs) {
+        maxUs = us;
+      }
+    }
+  };
+
+  FeedbackEngine& _feedback;
+  BLEServer* _pServer = nullptr;
+  BLEService* _pService = nullptr;
+  BLECharacteristic* _pCharacteristic = nullptr;
+  BLE2902* _pCccd = nullptr;
+  OtaService _ota;
+  BLEConnection _connections[BLE_MAX_CONNECTIONS];
+  portMUX_TYPE _connMux = portMUX_INITIALIZER_UNLOCKED;
+  volatile uint8_t _connectedCount = 0;
+  uint8_t _oldConnectedCount;
+  uint32_t _eventSeq = 0;
+  volatile uint16_t _settleDwellMs = SETTLE_DWELL_MS_DEFAULT;
+  volatile bool _diagPending = false;  // BLE task'ı yazar, loop okur (_connMux)
+  DiagRequest _diagReq = { DIAG_NONE, 0 };
+  uint16_t _diagConnId = 0;
+  uint16_t _diagReplyConnId = 0;
+  FanoutStats _fanout;
+  bool _advRestartPending = false;
+  uint32_t _advRestartAt = 0;
   bool _pairingModeActive = false;
   uint32_t _pairingModeStartTime = 0;
+  volatile bool _bleStarting = false;   // ble_start task'ı çalışıyor mu?
+  volatile bool _bleReady = false;      // enableBLE() tamamlandı (ble_start task'ı en son yazar)
+  volatile uint32_t _linkReadyUs = 0;   // BLE hazır olduğu an (micros)
+  int8_t _dleInFlight = -1;             // Sonucu beklenen data length isteğinin slot'u (_connMux)
+  uint16_t _dleConnId = 0;              // İsteğin gittiği bağlantı (slot yeniden kullanılırsa ayırt etmek için)
+  char _lastValue[128] = "";
   static const uint32_t PAIRING_MODE_DURATION_MS = 15000; // 15 saniye
+  static const uint32_t BLE_START_TASK_STACK = 6144;
+  static const uint32_t ADV_RESTART_DELAY_MS = 500;       // Kopmadan sonra stack'e zaman tanı
+
+  // Static GATTS handler'ı için (Bluedroid callback'i instance almaz).
+  // inline: başlık birden fazla .cpp'de include edilse de tek tanım
+  inline static BLEEventTransport* _instance = nullptr;
+
+  // connId ile bağlantı bul (mux tutulurken çağrılmalı)
+  BLEConnection* findConnection(uint16_t connId) {
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      if (_connections[i].active && _connections[i].connId == connId) {
+        return &_connections[i];
+      }
+    }
+    return nullptr;
+  }
+
+  void onPeerConnected(uint16_t connId, esp_bd_addr_t bda) {
+    bool added = false;
+    portENTER_CRITICAL(&_connMux);
+    if (findConnection(connId) == nullptr) {
+      for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        BLEConnection& c = _connections[i];
+        if (!c.active) {
+          c.active = true;
+          c.fresh = true;
+          c.connId = connId;
+          c.mtu = 23;
+          c.notify = false;
+          memcpy(c.bda, bda, sizeof(esp_bd_addr_t));
+          c.txPhy = 1;
+          c.rxPhy = 1;
+          c.dataLen = 27;
+          c.dlePending = true;
+          c.linkChanged = false;
+          c.congested = false;
+          c.pendingPing.valid = false;
+          c.lastPong.valid = false;
+          c.completed.valid = false;
+          _connectedCount++;
+          added = true;
+          break;
+        }
+      }
+    }
+    portEXIT_CRITICAL(&_connMux);
+    if (added) {
+      requestLinkUpgrade(bda);
+      startNextDle();
+    }
+  }
+
+  // Bağlantıyı hızlandır: 2M PHY (daha kısa radyo süresi). Data length extension (tek LL
+  // paketinde 251 byte) startNextDle ile sırayla istenir. Telefon desteklemezse bağlantı
+  // olduğu gibi devam eder.
+  static void requestLinkUpgrade(esp_bd_addr_t bda) {
+#if defined(CONFIG_BT_BLE_50_FEATURES_SUPPORTED)
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    esp_ble_gap_set_preferred_phy(bda, 0, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                  ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+#else
+    esp_ble_gap_set_prefered_phy(bda, 0, ESP_BLE_GAP_PHY_2M_PREF_MASK,
+                                 ESP_BLE_GAP_PHY_2M_PREF_MASK, ESP_BLE_GAP_PHY_OPTIONS_NO_PREF);
+#endif
+#endif
+  }
+
+  // Sıradaki bağlantı için data length iste. SET_PKT_LENGTH_COMPLETE olayı adres taşımaz;
+  // aynı anda tek istek olduğundan sonuç her zaman _dleInFlight'taki bağlantıya aittir.
+  void startNextDle() {
+    esp_bd_addr_t bda;
+    bool send = false;
+    portENTER_CRITICAL(&_connMux);
+    if (_dleInFlight < 0) {
+      for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        BLEConnection& c = _connections[i];
+        if (c.active && c.dlePending) {
+          c.dlePending = false;
+          _dleInFlight = i;
+          _dleConnId = c.connId;
+          memcpy(bda, c.bda, sizeof(esp_bd_addr_t));
+          send = true;
+          break;
+        }
+      }
+    }
+    portEXIT_CRITICAL(&_connMux);
+    if (send && esp_ble_gap_set_pkt_data_len(bda, BLE_DATA_LEN_MAX) != ESP_OK) {
+      // İstek kuyruğa girmedi: sonuç olayı gelmeyecek, sıradakine geç
+      portENTER_CRITICAL(&_connMux);
+      _dleInFlight = -1;
+      portEXIT_CRITICAL(&_connMux);
+      startNextDle();
+    }
+  }
+
+  // Link parametreleri değişti (MTU/PHY/DLE): tek satır logla
+  void printLink(BLEConnection& c) {
+    portENTER_CRITICAL(&_connMux);
+    c.linkChanged = false;
+    uint16_t mtu = c.mtu;
+    uint8_t txPhy = c.txPhy;
+    uint8_t rxPhy = c.rxPhy;
+    uint16_t dataLen = c.dataLen;
+    portEXIT_CRITICAL(&_connMux);
+    Serial.print("[BLE] link conn=");
+    Serial.print(c.connId);
+    Serial.print(" mtu=");
+    Serial.print(mtu);
+    Serial.print(" phy=");
+    Serial.print(phyName(txPhy));
+    Serial.print("/");
+    Serial.print(phyName(rxPhy));
+    Serial.print(" dle=");
+    Serial.println(dataLen);
+  }
+
+  static const char* phyName(uint8_t phy) {
+    switch (phy) {
+      case 1:  return "1M";
+      case 2:  return "2M";
+      case 3:  return "coded";
+      default: return "?";
+    }
+  }
+
+  void onPeerDisconnected(uint16_t connId) {
+    portENTER_CRITICAL(&_connMux);
+    BLEConnection* c = findConnection(connId);
+    if (c != nullptr) {
+      c->active = false;
+      _connectedCount--;
+    }
+    portEXIT_CRITICAL(&_connMux);
+    _ota.onDisconnect(connId);  // OTA yapan bağlantı koptuysa worker iptal eder
+  }
+
+  // Payload'u bağlantının kuyruğuna ekle; loop sonunda (flushPeers) tek notify'da gider.
+  // Batch sınırı anlaşılan MTU'ya göre (MTU-3); sığmazsa önce mevcut batch gönderilmeye çalışılır.
+  // App notify'ı satır sonlarından böler, bu yüzden her payload '\n' ile bitmelidir.
+  bool queuePeer(BLEConnection& c, const char* data, int len) {
+    if (len > (int)sizeof(c.tx)) {
+      return notifyPeer(c, data, len);  // Kuyruğa hiç sığmıyor: doğrudan parçalı gönder
+    }
+    if (c.txLen + len > batchCapacity(c)) {
+      flushPeer(c);  // Batch dolu (tıkanıklıkta gönderilmez, kuyruk büyümeye devam eder)
+    }
+    if (!appendTx(c, data, len)) {
+      return false;
+    }
+    c.queued++;
+    return true;
+  }
+
+  uint16_t batchCapacity(const BLEConnection& c) const {
+    uint16_t cap = c.mtu > 3 ? c.mtu - 3 : 20;
+    return cap < sizeof(c.tx) ? cap : sizeof(c.tx);
+  }
+
+  // Kuyruğa ekle. Yer yoksa payload bütün olarak atılır (yarım satır kalmaz), sayılır
+  bool appendTx(BLEConnection& c, const char* data, int len) {
+    if (c.txLen + len > (int)sizeof(c.tx)) {
+      c.txDropped++;
+      c.dropBurst++;
+      return false;
+    }
+    memcpy(c.tx + c.txLen, data, len);
+    c.txLen += len;
+    return true;
+  }
+
+  // Bekleyen veriyi gönder. Tıkanıklıkta (CONGEST_EVT) sonraki tura bırakılır; bu sürede gelen
+  // event'ler kuyruğa eklenir. Stack'in kabul etmediği kısım kuyrukta kalır ve sonraki turda
+  // (veya tıkanıklık bitince) tekrar denenir. Return: kuyruk boşaldı mı?
+  bool flushPeer(BLEConnection& c) {
+    if (c.txLen == 0) {
+      return true;
+    }
+    if (c.congested) {
+      return false;
+    }
+    int sent = sendChunks(c, c.tx, c.txLen);
+    if (sent > 0) {
+      memmove(c.tx, c.tx + sent, c.txLen - sent);
+      c.txLen -= sent;
+    }
+    if (c.txLen == 0 && c.dropBurst > 0) {
+      Serial.print("[BLE] tx overflow conn=");
+      Serial.print(c.connId);
+      Serial.print(" dropped=");
+      Serial.println(c.dropBurst);
+      c.dropBurst = 0;
+    }
+    return c.txLen == 0;
+  }
+
+  void flushPeers() {
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+      BLEConnection& c = _connections[i];
+      if (!c.active || !c.notify) {
+        c.txLen = 0;  // Alıcı yok (koptu / aboneliği bitti)
+        continue;
+      }
+      flushPeer(c);
+    }
+  }
+
+  // Tek bir bağlantıya hemen notify gönder (pong, tanılama); sıra bozulmasın diye kuyruğun sonuna
+  // eklenir. Kuyruktan uzun payload sadece kuyruk boşken gönderilir; kalanı sığmazsa atılır ve
+  // satır '\n' ile kapatılır (app sonraki satırla birleştirmez)
+  bool notifyPeer(BLEConnection& c, const char* data, int len) {
+    if (len <= (int)sizeof(c.tx)) {
+      return appendTx(c, data, len) && flushPeer(c);
+    }
+    int sent = flushPeer(c) ? sendChunks(c, data, len) : 0;
+    if (sent == 0) {
+      c.txDropped++;
+      c.dropBurst++;
+      return false;
+    }
+    if (sent < len && !appendTx(c, data + sent, len - sent)) {
+      appendTx(c, "\n", 1);
+      return false;
+    }
+    return true;
+  }
+
+  // MTU'dan uzunsa MTU-3'lük parçalara böl (app satır sonuna kadar birleştirir).
+  // Return: stack'in kabul ettiği byte (ilk reddedilen parçada durur)
+  int sendChunks(BLEConnection& c, const char* data, int len) {
+    if (!isBLEEnabled()) {
+      return 0;
+    }
+    uint16_t chunk = c.mtu > 3 ? c.mtu - 3 : 20;
+    int offset = 0;
+    while (offset < len) {
+      uint16_t n = (len - offset) < chunk ? (len - offset) : chunk;
+      esp_err_t err = esp_ble_gatts_send_indicate(_pServer->getGattsIf(), c.connId,
+                                                  _pCharacteristic->getHandle(), n,
+                                                  (uint8_t*)data + offset, false);
+      if (err != ESP_OK) {
+        c.notifyFailed++;
+        break;
+      }
+      c.notifySent++;
+      c.bytesSent += n;
+      offset += n;
+    }
+    return offset;
+  }
+
+  // Ham GATTS olayları: bağlantı başına MTU ve CCCD (notify aboneliği)
+  static void gattsHandler(esp_gatts_cb_event_t event, esp_gatt_if_t gattsIf,
+                           esp_ble_gatts_cb_param_t* param) {
+    BLEEventTransport* self = _instance;
+    if (self == nullptr) {
+      return;
+    }
+    if (event == ESP_GATTS_MTU_EVT) {
+      portENTER_CRITICAL(&self->_connMux);
+      BLEConnection* c = self->findConnection(param->mtu.conn_id);
+      if (c != nullptr) {
+        c->mtu = param->mtu.mtu;
+        c->linkChanged = true;
+      }
+      portEXIT_CRITICAL(&self->_connMux);
+    } else if (event == ESP_GATTS_CONGEST_EVT) {
+      portENTER_CRITICAL(&self->_connMux);
+      BLEConnection* c = self->findConnection(param->congest.conn_id);
+      if (c != nullptr) {
+        c->congested = param->congest.congested;
+      }
+      portEXIT_CRITICAL(&self->_connMux);
+    } else if (event == ESP_GATTS_WRITE_EVT && self->_pCccd != nullptr &&
+               param->write.handle == self->_pCccd->getHandle() && param->write.len >= 1) {
+      portENTER_CRITICAL(&self->_connMux);
+      BLEConnection* c = self->findConnection(param->write.conn_id);
+      if (c != nullptr) {
+        c->notify = (param->write.value[0] & 0x01) != 0;
+      }
+      portEXIT_CRITICAL(&self->_connMux);
+    }
+  }
+
+  // Ham GAP olayları: PHY ve data length sonuçları
+  static void gapHandler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    BLEEventTransport* self = _instance;
+    if (self == nullptr) {
+      return;
+    }
+#if defined(CONFIG_BT_BLE_50_FEATURES_SUPPORTED)
+    if (event == ESP_GAP_BLE_PHY_UPDATE_COMPLETE_EVT) {
+      if (param->phy_update.status != ESP_BT_STATUS_SUCCESS) {
+        return;
+      }
+      portENTER_CRITICAL(&self->_connMux);
+      for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++) {
+        BLEConnection& c = self->_connections[i];
+        if (c.active && memcmp(c.bda, param->phy_update.bda, sizeof(esp_bd_addr_t)) == 0) {
+          c.txPhy = param->phy_update.tx_phy;
+          c.rxPhy = param->phy_update.rx_phy;
+          c.linkChanged = true;
+          break;
+        }
+      }
+      portEXIT_CRITICAL(&self->_connMux);
+      return;
+    }
+#endif
+    if (event == ESP_GAP_BLE_SET_PKT_LENGTH_COMPLETE_EVT) {
+      // Olay adres taşımaz; sonuç tek bekleyen isteğe (_dleInFlight) aittir
+      portENTER_CRITICAL(&self->_connMux);
+      int8_t slot = self->_dleInFlight;
+      self->_dleInFlight = -1;
+      if (slot >= 0 && param->pkt_data_lenth_cmpl.status == ESP_BT_STATUS_SUCCESS) {
+        BLEConnection& c = self->_connections[slot];
+        // İstekten sonra kopan bağlantının slot'unu yeni bağlantı almış olabilir
+        if (c.active && c.connId == self->_dleConnId) {
+          c.dataLen = param->pkt_data_lenth_cmpl.params.tx_len;
+          c.linkChanged = true;
+        }
+      }
+      portEXIT_CRITICAL(&self->_connMux);
+      self->startNextDle();
+    }
+  }
+
+  // BLE'yi arka planda başlatan tek seferlik task
+  static void bleStartTask(void* arg) {
+    BLEEventTransport* transport = static_cast<BLEEventTransport*>(arg);
+    transport->enableBLE();
+    transport->_linkReadyUs = micros();
+    // En son: loop bu bayrağı gördüğünde server, characteristic ve handler'lar hazırdır
+    transport->_bleReady = true;
+    transport->_bleStarting = false;
+    vTaskDelete(nullptr);
+  }
   
   // BLE Server Callbacks
   class MyServerCallbacks: public BLEServerCallbacks {
@@ -364,12 +1355,27 @@ private:
   public:
     MyServerCallbacks(BLEEventTransport* transport) : _transport(transport) {}
     
-    void onConnect(BLEServer* pServer) {
-      _transport->setDeviceConnected(true);
+    void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+      _transport->onPeerConnected(param->connect.conn_id, param->connect.remote_bda);
     }
     
-    void onDisconnect(BLEServer* pServer) {
-      _transport->setDeviceConnected(false);
+    void onDisconnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) {
+      _transport->onPeerDisconnected(param->disconnect.conn_id);
+    }
+  };
+
+  // Characteristic yazma callback'i (saat senkronu ping'leri)
+  class MyCharacteristicCallbacks: public BLECharacteristicCallbacks {
+    BLEEventTransport* _transport;
+  public:
+    MyCharacteristicCallbacks(BLEEventTransport* transport) : _transport(transport) {}
+
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t* param) {
+      int64_t t2 = esp_timer_get_time();  // Alım anı - parse'tan önce
+      auto value = pCharacteristic->getValue();  // std::string (2.x) / String (3.x)
+      _transport->onPing(param->write.conn_id, value.c_str(), t2);
+      _transport->onSettleConfig(value.c_str());
+      _transport->onDiag(param->write.conn_id, value.c_str());
     }
   };
 };
@@ -379,10 +1385,7 @@ private:
 // TRANSPORT_BLE tanımlı değilse stub kullan (Simülasyon için)
 class BLEEventTransport : public IEventTransport {
 public:
-  BLEEventTransport(uint8_t ledPin) : _ledPin(ledPin) {
-    pinMode(_ledPin, OUTPUT);
-    digitalWrite(_ledPin, LOW);
-  }
+  BLEEventTransport(FeedbackEngine& feedback) : _feedback(feedback) {}
   
   void enableBLE() {
     // Stub: Simülasyon modunda işlem yok
@@ -414,9 +1417,7 @@ public:
 
   void sendEvent(const Event& event) override {
     // LED tetikleme
-    digitalWrite(_ledPin, HIGH);
-    delay(30);
-    digitalWrite(_ledPin, LOW);
+    _feedback.play(FB_ACK);
 
     // Event type string'e çevir
     const char* typeStr = "";
@@ -427,6 +1428,7 @@ public:
       case EVENT_CANCEL: typeStr = "CANCEL"; break;
       case AI_PRESS: typeStr = "AI_PRESS"; break;
       case AI_RELEASE: typeStr = "AI_RELEASE"; break;
+      case SETTLE: typeStr = "SETTLE"; break;
     }
 
     // Kompakt log formatı: [BLE] MAIN_ROTATE m=15 ts=12345
@@ -436,7 +1438,8 @@ public:
     // mainIndex sadece ilgili event'lerde
     if (event.type == MAIN_ROTATE || event.type == SUB_ROTATE || 
         event.type == CONFIRM || event.type == EVENT_CANCEL || 
-        event.type == AI_PRESS || event.type == AI_RELEASE) {
+        event.type == AI_PRESS || event.type == AI_RELEASE ||
+        event.type == SETTLE) {
       Serial.print(" m=");
       Serial.print(event.mainIndex);
     }
@@ -444,17 +1447,23 @@ public:
     // subIndex sadece ilgili event'lerde
     if (event.type == SUB_ROTATE || event.type == CONFIRM || 
         event.type == EVENT_CANCEL || event.type == AI_PRESS || 
-        event.type == AI_RELEASE) {
+        event.type == AI_RELEASE || event.type == SETTLE) {
       Serial.print(" s=");
       Serial.print(event.subIndex);
     }
+
+    // Dönüş hızı sadece rotate event'lerinde
+    if (event.type == MAIN_ROTATE || event.type == SUB_ROTATE) {
+      Serial.print(" v=");
+      Serial.print(event.velocity);
+    }
     
     Serial.print(" ts=");
     Serial.println(event.ts);
   }
 
 private:
-  uint8_t _ledPin;
+  FeedbackEngine& _feedback;
 };
 
 #endif // TRANSPORT_BLE
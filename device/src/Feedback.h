@@ -0,0 +1,254 @@
+#ifndef FEEDBACK_H
+#define FEEDBACK_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "pin.h"
+
+#ifdef PIN_RGB
+#include <Adafruit_NeoPixel.h>
+#endif
+
+/* =========================================================
+   FEEDBACK ENGINE (LED / Titreşim Geri Bildirimi)
+   =========================================================
+
+   Geri bildirimler deklaratif pattern'ler olarak tanımlanır:
+   her pattern (seviye, süre) adımlarından oluşur. Adımlar bir
+   esp_timer one-shot callback'i ile ilerletilir; loop() sadece
+   play() çağırır, bekleme veya yanıp söndürme yapmaz.
+
+   Çıkışlara sadece timer callback'i (esp_timer task'ı) yazar.
+   loop() durumu değiştirip timer'ı 0 süreyle kurar; böylece
+   adımlar ve _pixel.show() hiçbir zaman iki bağlamda eş zamanlı
+   çalışmaz.
+
+   Çıkışlar:
+   - PIN_LED:   LEDC PWM (parlaklık = seviye)
+   - PIN_VIBRO: LEDC PWM titreşim motoru (tanımlıysa, sadece
+                haptic pattern'lerde çalışır)
+   - PIN_RGB:   Kart üstü NeoPixel (tanımlıysa, renk pattern'e göre)
+
+   İki katman vardır:
+   - Arka plan (loop eden): pairing, advertising
+   - Ön plan (tek seferlik): ack, error
+   Ön plan bitince arka plan pattern'i baştan devam eder.
+*/
+
+enum FeedbackPattern : uint8_t {
+  FB_NONE = 0,
+  FB_ACK,          // Kullanıcı aksiyonu alındı (kısa darbe)
+  FB_PAIRING,      // Pairing mode (hızlı yanıp sönme)
+  FB_ADVERTISING,  // Bağlantı bekleniyor (yavaş yanıp sönme)
+  FB_ERROR,        // Hata (üç kısa darbe)
+  FB_PATTERN_COUNT
+};
+
+struct FeedbackStep {
+  uint8_t level;        // 0-255 (LED parlaklığı / motor gücü)
+  uint16_t durationMs;  // Adım süresi
+};
+
+struct FeedbackPatternDef {
+  const FeedbackStep* steps;
+  uint8_t count;
+  bool loop;        // Arka plan pattern'i mi?
+  bool haptic;      // Titreşim motoru da çalışsın mı?
+  uint32_t rgb;     // NeoPixel rengi (0xRRGGBB)
+};
+
+// Pattern tabloları
+static const FeedbackStep FB_STEPS_ACK[] = { {255, 30}, {0, 0} };
+static const FeedbackStep FB_STEPS_PAIRING[] = { {255, 250}, {0, 250} };
+static const FeedbackStep FB_STEPS_ADVERTISING[] = { {255, 500}, {0, 500} };
+static const FeedbackStep FB_STEPS_ERROR[] = {
+  {255, 80}, {0, 80}, {255, 80}, {0, 80}, {255, 80}, {0, 0}
+};
+
+#define FB_PATTERN(steps, loop, haptic, rgb) \
+  { steps, sizeof(steps) / sizeof(steps[0]), loop, haptic, rgb }
+
+static const FeedbackPatternDef FB_PATTERNS[FB_PATTERN_COUNT] = {
+  { nullptr, 0, false, false, 0 },                               // FB_NONE
+  FB_PATTERN(FB_STEPS_ACK,         false, true,  0x00FF00),      // FB_ACK
+  FB_PATTERN(FB_STEPS_PAIRING,     true,  false, 0x0000FF),      // FB_PAIRING
+  FB_PATTERN(FB_STEPS_ADVERTISING, true,  false, 0x0000FF),      // FB_ADVERTISING
+  FB_PATTERN(FB_STEPS_ERROR,       false, true,  0xFF0000),      // FB_ERROR
+};
+
+#undef FB_PATTERN
+
+class FeedbackEngine {
+public:
+  FeedbackEngine(uint8_t ledPin) : _ledPin(ledPin)
+#ifdef PIN_RGB
+    , _pixel(1, PIN_RGB, NEO_GRB + NEO_KHZ800)
+#endif
+  {}
+
+  // Çıkışları ve timer'ı hazırla (setup() içinde çağrılmalı)
+  void begin() {
+    attachPwm(_ledPin, LEDC_CHANNEL_LED);
+#ifdef PIN_VIBRO
+    attachPwm(PIN_VIBRO, LEDC_CHANNEL_VIBRO);
+#endif
+#ifdef PIN_RGB
+    _pixel.begin();
+    _pixel.clear();
+    _pixel.show();
+#endif
+    esp_timer_create_args_t args = {};
+    args.callback = &FeedbackEngine::onTimer;
+    args.arg = this;
+    args.name = "feedback";
+    esp_timer_create(&args, &_timer);
+    output(0, false, 0);
+  }
+
+  // Pattern oynat: loop eden pattern arka plan olur, diğerleri ön planda bir kez çalar
+  void play(FeedbackPattern pattern) {
+    if (pattern >= FB_PATTERN_COUNT) {
+      return;
+    }
+    if (FB_PATTERNS[pattern].loop) {
+      setBackground(pattern);
+      return;
+    }
+    portENTER_CRITICAL(&_mux);
+    _foreground = pattern;
+    _step = 0;
+    portEXIT_CRITICAL(&_mux);
+    restart();
+  }
+
+  // Arka plan pattern'ini değiştir (FB_NONE = kapalı). Aynı pattern tekrar verilirse yok sayılır.
+  void setBackground(FeedbackPattern pattern) {
+    if (pattern == _background) {
+      return;
+    }
+    bool idle;
+    portENTER_CRITICAL(&_mux);
+    _background = pattern;
+    idle = (_foreground == FB_NONE);
+    if (idle) {
+      _step = 0;
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (idle) {
+      restart();
+    }
+  }
+
+  FeedbackPattern background() const { return _background; }
+
+private:
+  static const uint8_t LEDC_CHANNEL_LED = 0;
+  static const uint8_t LEDC_CHANNEL_VIBRO = 1;
+  static const uint32_t LEDC_FREQ_HZ = 5000;
+  static const uint8_t LEDC_RESOLUTION_BITS = 8;
+
+  uint8_t _ledPin;
+#ifdef PIN_RGB
+  Adafruit_NeoPixel _pixel;
+#endif
+  esp_timer_handle_t _timer = nullptr;
+  portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+  volatile FeedbackPattern _background = FB_NONE;
+  volatile FeedbackPattern _foreground = FB_NONE;
+  volatile uint8_t _step = 0;
+
+  static void attachPwm(uint8_t pin, uint8_t channel) {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    (void)channel;
+    ledcAttach(pin, LEDC_FREQ_HZ, LEDC_RESOLUTION_BITS);
+#else
+    ledcSetup(channel, LEDC_FREQ_HZ, LEDC_RESOLUTION_BITS);
+    ledcAttachPin(pin, channel);
+#endif
+  }
+
+  static void writePwm(uint8_t pin, uint8_t channel, uint8_t duty) {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    (void)channel;
+    ledcWrite(pin, duty);
+#else
+    (void)pin;
+    ledcWrite(channel, duty);
+#endif
+  }
+
+  // Tüm çıkışlara seviyeyi uygula
+  void output(uint8_t level, bool haptic, uint32_t rgb) {
+    writePwm(_ledPin, LEDC_CHANNEL_LED, level);
+#ifdef PIN_VIBRO
+    writePwm(PIN_VIBRO, LEDC_CHANNEL_VIBRO, haptic ? level : 0);
+#else
+    (void)haptic;
+#endif
+#ifdef PIN_RGB
+    uint8_t r = ((rgb >> 16) & 0xFF) * level / 255;
+    uint8_t g = ((rgb >> 8) & 0xFF) * level / 255;
+    uint8_t b = (rgb & 0xFF) * level / 255;
+    _pixel.setPixelColor(0, _pixel.Color(r, g, b));
+    _pixel.show();
+#else
+    (void)rgb;
+#endif
+  }
+
+  // Mevcut adımı timer bağlamında hemen uygulat (loop'tan çağrılır).
+  // esp_timer_stop çalışan callback'i beklemez; callback o arada timer'ı
+  // kurarsa start INVALID_STATE döner, durdurup tekrar denenir.
+  void restart() {
+    for (uint8_t i = 0; i < 3; i++) {
+      esp_timer_stop(_timer);
+      if (esp_timer_start_once(_timer, 0) != ESP_ERR_INVALID_STATE) {
+        return;
+      }
+    }
+  }
+
+  // Mevcut adımı uygula ve bir sonraki adım için timer'ı kur (sadece timer callback'inden)
+  void advance() {
+    while (true) {
+      FeedbackPattern active;
+      uint8_t step;
+      portENTER_CRITICAL(&_mux);
+      active = (_foreground != FB_NONE) ? _foreground : _background;
+      step = _step;
+      const FeedbackPatternDef& def = FB_PATTERNS[active];
+      if (step >= def.count) {
+        if (active == _foreground) {
+          // Ön plan bitti - arka plana dön
+          _foreground = FB_NONE;
+          active = _background;
+        }
+        step = 0;
+      }
+      _step = step + 1;
+      portEXIT_CRITICAL(&_mux);
+
+      const FeedbackPatternDef& current = FB_PATTERNS[active];
+      if (current.count == 0) {
+        output(0, false, 0);  // FB_NONE: çıkışları kapat
+        return;
+      }
+      const FeedbackStep& s = current.steps[step];
+      output(s.level, current.haptic, current.rgb);
+      if (s.durationMs > 0) {
+        esp_timer_start_once(_timer, (uint64_t)s.durationMs * 1000);
+        return;
+      }
+      if (current.loop) {
+        return;
+      }
+      // Süresiz son adım: ön planı hemen bitir, arka plan adımına geç
+    }
+  }
+
+  static void onTimer(void* arg) {
+    static_cast<FeedbackEngine*>(arg)->advance();
+  }
+};
+
+#endif // FEEDBACK_H
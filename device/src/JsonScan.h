@@ -0,0 +1,37 @@
+#ifndef JSON_SCAN_H
+#define JSON_SCAN_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* =========================================================
+   JSON SCAN (Küçük Komut JSON'ları İçin Alan Okuyucu)
+   =========================================================
+
+   App'in yazdığı komutlar tek seviyeli ve kısadır
+   ({"sync":..,"t1":..}, {"ota":"begin","size":..} gibi); tam bir
+   JSON parser yerine key aranır ve arkasındaki tamsayı okunur.
+   key, tırnak ve iki nokta dahil verilir: "\"size\":"
+
+   EventTransport (ping, settle, diag) ve OtaService aynı okuyucuyu
+   kullanır. Arduino bağımlılığı yoktur.
+*/
+
+// key'den sonra gelen tamsayıyı oku. Key yoksa veya sayı gelmiyorsa false
+static inline bool jsonInt64(const char* json, const char* key, int64_t* out) {
+  const char* p = strstr(json, key);
+  if (p == nullptr) {
+    return false;
+  }
+  p += strlen(key);
+  char* end = nullptr;
+  long long value = strtoll(p, &end, 10);
+  if (end == p) {
+    return false;
+  }
+  *out = value;
+  return true;
+}
+
+#endif // JSON_SCAN_H
@@ -0,0 +1,408 @@
+#ifndef OTA_DECODER_H
+#define OTA_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* =========================================================
+   OTA DECODER (Akışlı Açma / Delta Uygulama)
+   =========================================================
+
+   BLE'den parça parça gelen OTA verisini, tamamını RAM'de
+   tutmadan çözer ve sonucu bir OtaSink'e (flash) yazar.
+
+   Zincir:  giriş -> [heatshrink açma] -> [delta uygulama] -> sink
+
+   - Heatshrink: LZSS, bit akışı MSB önce. Etiket biti 1 ise
+     8 bit literal, 0 ise W bit index + L bit count gelir
+     (offset = index + 1, uzunluk = count + 1). Pencere 2^W
+     byte (en fazla 4KB), başlangıçta sıfırlarla dolu.
+     Son bayttaki dolgu bitleri (< 8) tam bir token oluşturamaz.
+   - Delta: çalışan firmware'e (base) göre yama. İşlemler
+     (little endian):
+       0x01 COPY   u32 baseOffset, u32 len   -> base'den kopyala
+       0x02 INSERT u32 len, len byte         -> veriyi yaz
+
+   Bu dosya Arduino'ya bağımlı değildir (host'ta derlenebilir).
+*/
+
+// Çıkış hedefi (ör. esp_ota_write + SHA-256)
+class OtaSink {
+public:
+  virtual ~OtaSink() {}
+  virtual bool write(const uint8_t* data, size_t len) = 0;
+};
+
+// Delta için mevcut firmware okuyucu (ör. esp_partition_read)
+class OtaBaseReader {
+public:
+  virtual ~OtaBaseReader() {}
+  virtual bool read(uint32_t offset, uint8_t* data, size_t len) = 0;
+  virtual uint32_t size() const = 0;
+};
+
+enum OtaEncoding : uint8_t {
+  OTA_ENC_RAW = 0,         // Sıkıştırmasız
+  OTA_ENC_HEATSHRINK = 1   // Heatshrink (LZSS)
+};
+
+enum OtaDecodeError : uint8_t {
+  OTA_OK = 0,
+  OTA_ERR_PARAMS,      // Geçersiz W/L veya boyut
+  OTA_ERR_SINK,        // Flash yazma hatası
+  OTA_ERR_BASE,        // Base okunamadı / sınır dışı COPY
+  OTA_ERR_DELTA,       // Bozuk delta işlemi
+  OTA_ERR_OVERFLOW,    // Beklenenden fazla çıkış
+  OTA_ERR_TRUNCATED    // Beklenenden az çıkış
+};
+
+/* ---------------------------------------------------------
+   Delta uygulayıcı: yama byte'larını alır, görüntüyü sink'e yazar
+   --------------------------------------------------------- */
+class OtaDeltaPatcher {
+public:
+  void begin(OtaBaseReader* base, OtaSink* sink) {
+    _base = base;
+    _sink = sink;
+    _state = OP;
+    _fieldBytes = 0;
+    _field = 0;
+    _remaining = 0;
+    _error = OTA_OK;
+  }
+
+  bool feed(const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len && _error == OTA_OK) {
+      switch (_state) {
+        case OP:
+          _op = data[i++];
+          if (_op != OP_COPY && _op != OP_INSERT) {
+            _error = OTA_ERR_DELTA;
+            return false;
+          }
+          _state = (_op == OP_COPY) ? COPY_OFFSET : INSERT_LEN;
+          _fieldBytes = 0;
+          _field = 0;
+          break;
+
+        case COPY_OFFSET:
+        case COPY_LEN:
+        case INSERT_LEN:
+          _field |= (uint32_t)data[i++] << (8 * _fieldBytes);
+          if (++_fieldBytes < 4) {
+            break;
+          }
+          _fieldBytes = 0;
+          if (_state == COPY_OFFSET) {
+            _copyOffset = _field;
+            _field = 0;
+            _state = COPY_LEN;
+          } else if (_state == COPY_LEN) {
+            if (!copyFromBase(_copyOffset, _field)) {
+              return false;
+            }
+            _field = 0;
+            _state = OP;
+          } else {
+            _remaining = _field;
+            _field = 0;
+            _state = _remaining > 0 ? INSERT_DATA : OP;
+          }
+          break;
+
+        case INSERT_DATA: {
+          size_t n = len - i;
+          if (n > _remaining) {
+            n = _remaining;
+          }
+          if (!_sink->write(data + i, n)) {
+            _error = OTA_ERR_SINK;
+            return false;
+          }
+          i += n;
+          _remaining -= n;
+          if (_remaining == 0) {
+            _state = OP;
+          }
+          break;
+        }
+      }
+    }
+    return _error == OTA_OK;
+  }
+
+  // Yama bir işlemin ortasında bitmemeli
+  bool isIdle() const { return _state == OP; }
+  OtaDecodeError error() const { return _error; }
+
+private:
+  static const uint8_t OP_COPY = 0x01;
+  static const uint8_t OP_INSERT = 0x02;
+  static const size_t COPY_CHUNK = 256;
+
+  enum State : uint8_t { OP, COPY_OFFSET, COPY_LEN, INSERT_LEN, INSERT_DATA };
+
+  OtaBaseReader* _base = nullptr;
+  OtaSink* _sink = nullptr;
+  State _state = OP;
+  uint8_t _op = 0;
+  uint8_t _fieldBytes = 0;
+  uint32_t _field = 0;
+  uint32_t _copyOffset = 0;
+  uint32_t _remaining = 0;
+  OtaDecodeError _error = OTA_OK;
+
+  bool copyFromBase(uint32_t offset, uint32_t len) {
+    if (_base == nullptr || offset > _base->size() || len > _base->size() - offset) {
+      _error = OTA_ERR_BASE;
+      return false;
+    }
+    uint8_t buf[COPY_CHUNK];
+    while (len > 0) {
+      size_t n = len < COPY_CHUNK ? len : COPY_CHUNK;
+      if (!_base->read(offset, buf, n)) {
+        _error = OTA_ERR_BASE;
+        return false;
+      }
+      if (!_sink->write(buf, n)) {
+        _error = OTA_ERR_SINK;
+        return false;
+      }
+      offset += n;
+      len -= n;
+    }
+    return true;
+  }
+};
+
+/* ---------------------------------------------------------
+   Heatshrink akışlı açıcı
+   --------------------------------------------------------- */
+class HeatshrinkDecoder {
+public:
+  static const uint8_t MIN_WINDOW_BITS = 4;
+  static const uint8_t MAX_WINDOW_BITS = 12;  // 4KB pencere (statik)
+  static const uint8_t MIN_LOOKAHEAD_BITS = 3;
+
+  bool begin(uint8_t windowBits, uint8_t lookaheadBits) {
+    if (windowBits < MIN_WINDOW_BITS || windowBits > MAX_WINDOW_BITS ||
+        lookaheadBits < MIN_LOOKAHEAD_BITS || lookaheadBits >= windowBits) {
+      return false;
+    }
+    _windowBits = windowBits;
+    _lookaheadBits = lookaheadBits;
+    _mask = (1u << windowBits) - 1;
+    memset(_window, 0, sizeof(_window));
+    _pos = 0;
+    _bits = 0;
+    _bitCount = 0;
+    _state = TAG;
+    _outLen = 0;
+    return true;
+  }
+
+  // Girişi çöz; çıkış parçalar halinde emit() ile verilir.
+  // Emit: bool(const uint8_t*, size_t) çağrılabilir nesne (ör. lambda)
+  template <typename Emit>
+  bool feed(const uint8_t* data, size_t len, Emit emit) {
+    for (size_t i = 0; i < len; i++) {
+      _bits = (_bits << 8) | data[i];
+      _bitCount += 8;
+      if (!drain(emit)) {
+        return false;
+      }
+    }
+    return flush(emit);
+  }
+
+private:
+  enum State : uint8_t { TAG, LITERAL, INDEX, COUNT };
+  static const size_t OUT_CHUNK = 256;
+
+  uint8_t _window[1 << MAX_WINDOW_BITS];
+  uint8_t _out[OUT_CHUNK];
+  size_t _outLen = 0;
+  uint8_t _windowBits = 0;
+  uint8_t _lookaheadBits = 0;
+  uint32_t _mask = 0;
+  uint32_t _pos = 0;
+  uint32_t _bits = 0;       // Henüz tüketilmemiş bitler (en fazla 8 + 12)
+  uint8_t _bitCount = 0;
+  State _state = TAG;
+  uint16_t _index = 0;
+
+  uint32_t take(uint8_t n) {
+    _bitCount -= n;
+    return (_bits >> _bitCount) & ((1u << n) - 1);
+  }
+
+  template <typename Emit>
+  bool put(uint8_t b, Emit& emit) {
+    _window[_pos++ & _mask] = b;
+    _out[_outLen++] = b;
+    if (_outLen == OUT_CHUNK) {
+      return flush(emit);
+    }
+    return true;
+  }
+
+  template <typename Emit>
+  bool flush(Emit& emit) {
+    if (_outLen == 0) {
+      return true;
+    }
+    size_t n = _outLen;
+    _outLen = 0;
+    return emit(_out, n);
+  }
+
+  template <typename Emit>
+  bool drain(Emit& emit) {
+    while (true) {
+      switch (_state) {
+        case TAG:
+          if (_bitCount < 1) return true;
+          _state = take(1) ? LITERAL : INDEX;
+          break;
+        case LITERAL:
+          if (_bitCount < 8) return true;
+          if (!put((uint8_t)take(8), emit)) return false;
+          _state = TAG;
+          break;
+        case INDEX:
+          if (_bitCount < _windowBits) return true;
+          _index = take(_windowBits);
+          _state = COUNT;
+          break;
+        case COUNT: {
+          if (_bitCount < _lookaheadBits) return true;
+          uint32_t count = take(_lookaheadBits) + 1;
+          uint32_t offset = (uint32_t)_index + 1;
+          for (uint32_t k = 0; k < count; k++) {
+            if (!put(_window[(_pos - offset) & _mask], emit)) return false;
+          }
+          _state = TAG;
+          break;
+        }
+      }
+    }
+  }
+};
+
+/* ---------------------------------------------------------
+   OTA zinciri: açma + (opsiyonel) delta + boyut kontrolü
+   --------------------------------------------------------- */
+class OtaDecoder {
+public:
+  // outSize: Oluşacak firmware görüntüsünün byte sayısı (header'dan)
+  bool begin(OtaEncoding encoding, bool delta, uint8_t windowBits, uint8_t lookaheadBits,
+             uint32_t outSize, OtaBaseReader* base, OtaSink* sink) {
+    _encoding = encoding;
+    _delta = delta;
+    _outSize = outSize;
+    _produced = 0;
+    _consumed = 0;
+    _sink = sink;
+    _error = OTA_OK;
+    _limit.owner = this;
+    if (outSize == 0 || sink == nullptr || (delta && base == nullptr)) {
+      _error = OTA_ERR_PARAMS;
+      return false;
+    }
+    if (encoding == OTA_ENC_HEATSHRINK && !_hs.begin(windowBits, lookaheadBits)) {
+      _error = OTA_ERR_PARAMS;
+      return false;
+    }
+    if (encoding != OTA_ENC_RAW && encoding != OTA_ENC_HEATSHRINK) {
+      _error = OTA_ERR_PARAMS;
+      return false;
+    }
+    if (delta) {
+      _patcher.begin(base, &_limit);
+    }
+    return true;
+  }
+
+  // BLE'den gelen ham veriyi işle
+  bool feed(const uint8_t* data, size_t len) {
+    if (_error != OTA_OK) {
+      return false;
+    }
+    _consumed += len;
+    if (_encoding == OTA_ENC_HEATSHRINK) {
+      return _hs.feed(data, len, [this](const uint8_t* d, size_t n) { return stage2(d, n); });
+    }
+    return stage2(data, len);
+  }
+
+  // Akış bitti: çıkış tam olarak outSize mı?
+  bool finish() {
+    if (_error != OTA_OK) {
+      return false;
+    }
+    if (_delta && !_patcher.isIdle()) {
+      _error = OTA_ERR_DELTA;
+      return false;
+    }
+    if (_produced != _outSize) {
+      _error = OTA_ERR_TRUNCATED;
+      return false;
+    }
+    return true;
+  }
+
+  OtaDecodeError error() const { return _error; }
+  uint32_t produced() const { return _produced; }
+  uint32_t consumed() const { return _consumed; }
+
+private:
+  // Çıkışı sayan ve outSize'ı aşmayı engelleyen sink sarmalayıcı
+  struct LimitSink : public OtaSink {
+    OtaDecoder* owner = nullptr;
+    bool write(const uint8_t* data, size_t len) override {
+      return owner->emitOut(data, len);
+    }
+  };
+
+  OtaEncoding _encoding = OTA_ENC_RAW;
+  bool _delta = false;
+  uint32_t _outSize = 0;
+  uint32_t _produced = 0;
+  uint32_t _consumed = 0;
+  OtaSink* _sink = nullptr;
+  OtaDecodeError _error = OTA_OK;
+  HeatshrinkDecoder _hs;
+  OtaDeltaPatcher _patcher;
+  LimitSink _limit;
+
+  // Açılmış veri: delta ise yamaya, değilse doğrudan çıkışa
+  bool stage2(const uint8_t* data, size_t len) {
+    if (_delta) {
+      if (!_patcher.feed(data, len)) {
+        if (_error == OTA_OK) {
+          _error = _patcher.error();
+        }
+        return false;
+      }
+      return true;
+    }
+    return emitOut(data, len);
+  }
+
+  bool emitOut(const uint8_t* data, size_t len) {
+    if (len > _outSize - _produced) {
+      _error = OTA_ERR_OVERFLOW;
+      return false;
+    }
+    if (!_sink->write(data, len)) {
+      _error = OTA_ERR_SINK;
+      return false;
+    }
+    _produced += len;
+    return true;
+  }
+};
+
+#endif // OTA_DECODER_H
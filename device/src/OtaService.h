@@ -0,0 +1,472 @@
+#ifndef OTA_SERVICE_H
+#define OTA_SERVICE_H
+
+#include <Arduino.h>
+#include <BLEDevice.h>
+#include <BLEServer.h>
+#include <BLE2902.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+#include <mbedtls/sha256.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/stream_buffer.h>
+#include <freertos/semphr.h>
+#include <new>
+#include "OtaDecoder.h"
+#include "JsonScan.h"
+
+/* =========================================================
+   OTA SERVICE (BLE Üzerinden Firmware Güncelleme)
+   =========================================================
+
+   Mevcut GATT servisine iki characteristic ekler:
+   - OTA_CONTROL (write + notify): JSON komut/cevap
+   - OTA_DATA    (write without response): ham görüntü verisi
+
+   Akış:
+   1. App -> control: {"ota":"begin","size":<gelecek byte>,"out":<görüntü byte>,
+                       "enc":0|1,"w":10,"l":4,"delta":0|1,"sha":"<64 hex>"}
+      enc: 0 = sıkıştırmasız, 1 = heatshrink (w/l = pencere/lookahead bit)
+      delta: 1 ise veri, çalışan firmware'e göre yamadır (bkz. OtaDecoder.h)
+   2. Cihaz -> {"ota":"ready","window":<byte>}
+   3. App data'yı MTU-3 byte'lık write-without-response parçalarıyla gönderir,
+      onaylanmamış veri "window"u aşmamalı.
+   4. Cihaz her OTA_ACK_BYTES işlendiğinde -> {"ota":"ack","rx":<işlenen byte>}
+   5. size byte işlenince SHA-256 doğrulanır, boot partition değişir:
+      {"ota":"done","ms":..,"ram":..} ve cihaz yeniden başlar.
+      Hata: {"ota":"error","code":<OtaDecodeError | 100+>}
+   İptal: App -> {"ota":"abort"}. Güncellemeyi başlatan bağlantı koparsa veya
+   OTA_IDLE_TIMEOUT_MS boyunca veri gelmezse güncelleme kendiliğinden iptal
+   olur (code 106 / 107) ve worker _active'i temizler.
+
+   Cevaplar (ready/ack/done/error) sadece begin'i yazan bağlantıya gider
+   (esp_ble_gatts_send_indicate); BLE task'ı ve worker aynı anda
+   göndermesin diye bir mutex ile sıralanır.
+
+   BLE callback'i sadece veriyi stream buffer'a kopyalar; açma,
+   SHA-256 ve flash yazma ayrı bir worker task'ta yapılır. Stream
+   buffer ilk güncellemede bir kez oluşturulur ve silinmez (her
+   begin'de sıfırlanır); geç gelen bir data write'ı serbest bırakılmış
+   belleğe yazamaz.
+
+   Güvenlik: iki characteristic de sadece şifreli bağlantıdan yazılabilir
+   (ESP_GATT_PERM_WRITE_ENCRYPTED). Şifresiz yazım stack tarafından
+   reddedilir; telefon ilk control yazımında eşleşme (bonding) başlatır.
+   SHA-256 sadece aktarım bütünlüğü içindir. Görüntü imzası için
+   sdkconfig'te CONFIG_SECURE_SIGNED_APPS_* açılırsa esp_ota_end imzayı
+   da doğrular.
+
+   Kabul metrikleri Serial'e basılır:
+   [OTA] done rx=.. out=.. ms=.. kbps=.. peak_ram=..
+*/
+
+#define OTA_CONTROL_UUID "12345678-1234-1234-1234-123456789abe"
+#define OTA_DATA_UUID    "12345678-1234-1234-1234-123456789abf"
+
+class OtaService {
+public:
+  static const uint32_t OTA_WINDOW_BYTES = 16384;  // Stream buffer = akış kontrol penceresi
+  static const uint32_t OTA_ACK_BYTES = 4096;
+  static const uint32_t OTA_TASK_STACK = 6144;
+  static const size_t OTA_RX_CHUNK = 1024;
+  static const uint32_t OTA_IDLE_TIMEOUT_MS = 10000;  // Bu kadar veri gelmezse iptal
+
+  // Error kodları: OtaDecodeError (1-6) + servis hataları
+  enum ServiceError : uint8_t {
+    OTA_SVC_BUSY = 100,       // Zaten bir güncelleme sürüyor
+    OTA_SVC_BAD_BEGIN = 101,  // Eksik/geçersiz begin parametresi
+    OTA_SVC_NO_MEMORY = 102,
+    OTA_SVC_PARTITION = 103,  // esp_ota_begin/end/set_boot hatası
+    OTA_SVC_HASH = 104,       // SHA-256 uyuşmadı
+    OTA_SVC_OVERRUN = 105,    // App pencereyi aştı, veri kayboldu
+    OTA_SVC_ABORTED = 106,    // App iptal etti veya bağlantı koptu
+    OTA_SVC_TIMEOUT = 107     // OTA_IDLE_TIMEOUT_MS boyunca veri gelmedi
+  };
+
+  // Characteristic'leri servise ekle (service->start() öncesi çağrılmalı)
+  void attach(BLEServer* server, BLEService* service) {
+    _server = server;
+    if (_notifyLock == nullptr) {
+      _notifyLock = xSemaphoreCreateMutex();
+    }
+    _control = service->createCharacteristic(
+      OTA_CONTROL_UUID,
+      BLECharacteristic::PROPERTY_WRITE |
+      BLECharacteristic::PROPERTY_NOTIFY
+    );
+    _control->setAccessPermissions(ESP_GATT_PERM_WRITE_ENCRYPTED);
+    BLE2902* cccd = new BLE2902();
+    cccd->setAccessPermissions(ESP_GATT_PERM_READ_ENCRYPTED | ESP_GATT_PERM_WRITE_ENCRYPTED);
+    _control->addDescriptor(cccd);
+    _control->setCallbacks(new ControlCallbacks(this));
+
+    _data = service->createCharacteristic(
+      OTA_DATA_UUID,
+      BLECharacteristic::PROPERTY_WRITE_NR
+    );
+    _data->setAccessPermissions(ESP_GATT_PERM_WRITE_ENCRYPTED);
+    _data->setCallbacks(new DataCallbacks(this));
+
+    enableBonding();
+  }
+
+  bool isActive() const { return _active; }
+
+  // Bağlantı koptu (BLE task'ı): güncellemeyi başlatan bağlantıysa worker'ı iptal ettir
+  void onDisconnect(uint16_t connId) {
+    if (_active && connId == _peerConnId) {
+      _abort = true;
+    }
+  }
+
+private:
+  BLEServer* _server = nullptr;
+  BLECharacteristic* _control = nullptr;
+  SemaphoreHandle_t _notifyLock = nullptr;
+  volatile uint16_t _peerConnId = 0;  // begin'i yazan bağlantı
+  BLECharacteristic* _data = nullptr;
+  volatile bool _active = false;
+  volatile bool _abort = false;
+  volatile bool _overrun = false;
+  StreamBufferHandle_t _stream = nullptr;
+
+  // begin parametreleri
+  uint32_t _size = 0;
+  uint32_t _outSize = 0;
+  OtaEncoding _encoding = OTA_ENC_RAW;
+  uint8_t _windowBits = 0;
+  uint8_t _lookaheadBits = 0;
+  bool _delta = false;
+  uint8_t _expectedSha[32];
+
+  // Ölçüm
+  uint32_t _startMs = 0;
+  uint32_t _heapBefore = 0;
+  uint32_t _heapMin = 0;
+
+  // Flash hedefi: esp_ota_write + SHA-256
+  struct FlashSink : public OtaSink {
+    esp_ota_handle_t handle = 0;
+    mbedtls_sha256_context sha;
+    bool write(const uint8_t* data, size_t len) override {
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+      mbedtls_sha256_update(&sha, data, len);
+#else
+      mbedtls_sha256_update_ret(&sha, data, len);
+#endif
+      return esp_ota_write(handle, data, len) == ESP_OK;
+    }
+  };
+
+  // Eşleşme parametreleri: cihazda ekran/tuş girişi yok (Just Works),
+  // Secure Connections + bonding ile anahtarlar saklanır
+  static void enableBonding() {
+    esp_ble_auth_req_t auth = ESP_LE_AUTH_REQ_SC_BOND;
+    esp_ble_io_cap_t ioCap = ESP_IO_CAP_NONE;
+    uint8_t keySize = 16;
+    uint8_t keys = ESP_BLE_ENC_KEY_MASK | ESP_BLE_ID_KEY_MASK;
+    esp_ble_gap_set_security_param(ESP_BLE_SM_AUTHEN_REQ_MODE, &auth, sizeof(auth));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_IOCAP_MODE, &ioCap, sizeof(ioCap));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_MAX_KEY_SIZE, &keySize, sizeof(keySize));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_SET_INIT_KEY, &keys, sizeof(keys));
+    esp_ble_gap_set_security_param(ESP_BLE_SM_SET_RSP_KEY, &keys, sizeof(keys));
+  }
+
+  // Delta için çalışan firmware partition'ı
+  struct PartitionReader : public OtaBaseReader {
+    const esp_partition_t* part = nullptr;
+    bool read(uint32_t offset, uint8_t* data, size_t len) override {
+      return esp_partition_read(part, offset, data, len) == ESP_OK;
+    }
+    uint32_t size() const override { return part != nullptr ? part->size : 0; }
+  };
+
+  // Sadece connId'ye notify (BLE task'ı ve worker'dan çağrılır, mutex ile sıralı)
+  void notifyControl(uint16_t connId, const char* json) {
+    if (_server == nullptr || _notifyLock == nullptr) {
+      return;
+    }
+    xSemaphoreTake(_notifyLock, portMAX_DELAY);
+    esp_ble_gatts_send_indicate(_server->getGattsIf(), connId, _control->getHandle(),
+                                strlen(json), (uint8_t*)json, false);
+    xSemaphoreGive(_notifyLock);
+  }
+
+  void notifyError(uint16_t connId, uint8_t code) {
+    char msg[48];
+    snprintf(msg, sizeof(msg), "{\"ota\":\"error\",\"code\":%u}", code);
+    notifyControl(connId, msg);
+    Serial.print("[OTA] error code=");
+    Serial.println(code);
+  }
+
+  // Control komutları (BLE task'ı)
+  void onControl(uint16_t connId, const char* json) {
+    if (strstr(json, "\"abort\"") != nullptr) {
+      if (_active && connId == _peerConnId) {
+        _abort = true;
+      }
+      return;
+    }
+    if (strstr(json, "\"begin\"") == nullptr) {
+      return;
+    }
+    if (_active) {
+      notifyError(connId, OTA_SVC_BUSY);
+      return;
+    }
+
+    int64_t size = 0, out = 0, enc = 0, w = 0, l = 0, delta = 0;
+    const char* sha = strstr(json, "\"sha\":\"");
+    if (!jsonInt64(json, "\"size\":", &size) || !jsonInt64(json, "\"out\":", &out) ||
+        size <= 0 || out <= 0 || sha == nullptr || !parseHex(sha + 7, _expectedSha, 32)) {
+      notifyError(connId, OTA_SVC_BAD_BEGIN);
+      return;
+    }
+    jsonInt64(json, "\"enc\":", &enc);
+    jsonInt64(json, "\"w\":", &w);
+    jsonInt64(json, "\"l\":", &l);
+    jsonInt64(json, "\"delta\":", &delta);
+    _size = (uint32_t)size;
+    _outSize = (uint32_t)out;
+    _encoding = (OtaEncoding)enc;
+    _windowBits = (uint8_t)w;
+    _lookaheadBits = (uint8_t)l;
+    _delta = delta != 0;
+
+    _startMs = millis();
+    _heapBefore = esp_get_free_heap_size();
+    _heapMin = _heapBefore;
+    _abort = false;
+    _overrun = false;
+    _peerConnId = connId;
+    // Bir kez oluşturulur, hiç silinmez: onData ile aynı (BLE) task'tayız ve
+    // _active false iken okuyan yok, reset güvenli
+    if (_stream == nullptr) {
+      _stream = xStreamBufferCreate(OTA_WINDOW_BYTES, 1);
+      if (_stream == nullptr) {
+        notifyError(connId, OTA_SVC_NO_MEMORY);
+        return;
+      }
+    } else {
+      xStreamBufferReset(_stream);  // Önceki başarısız denemeden kalan veri
+    }
+    _active = true;
+    if (xTaskCreatePinnedToCore(workerTask, "ota", OTA_TASK_STACK, this, 1, nullptr, 0) != pdPASS) {
+      _active = false;
+      notifyError(connId, OTA_SVC_NO_MEMORY);
+    }
+  }
+
+  // Data parçaları (BLE task'ı) - sadece kopyala, bekleme yok
+  void onData(uint16_t connId, const uint8_t* data, size_t len) {
+    if (!_active || _stream == nullptr || connId != _peerConnId) {
+      return;
+    }
+    if (xStreamBufferSend(_stream, data, len, 0) != len) {
+      _overrun = true;  // App onay beklemeden pencereyi aştı
+    }
+  }
+
+  void sampleHeap() {
+    uint32_t freeHeap = esp_get_free_heap_size();
+    if (freeHeap < _heapMin) {
+      _heapMin = freeHeap;
+    }
+  }
+
+  // Açma + SHA + flash yazma (ayrı task, loop'u ve BLE stack'ini bekletmez)
+  static void workerTask(void* arg) {
+    OtaService* self = static_cast<OtaService*>(arg);
+    uint8_t code = self->runUpdate();
+    if (code == OTA_OK) {
+      vTaskDelay(pdMS_TO_TICKS(1000));  // "done" bildirimi gitsin (_active açık: yeni begin yok)
+      esp_restart();
+    }
+    // Stream buffer silinmez; sonraki begin onu sıfırlar
+    self->_active = false;
+    self->notifyError(self->_peerConnId, code);
+    vTaskDelete(nullptr);
+  }
+
+  uint8_t runUpdate() {
+    const esp_partition_t* target = esp_ota_get_next_update_partition(nullptr);
+    if (target == nullptr || _outSize > target->size) {
+      return OTA_SVC_PARTITION;
+    }
+
+    OtaDecoder* decoder = new (std::nothrow) OtaDecoder();
+    FlashSink* sink = new (std::nothrow) FlashSink();
+    PartitionReader base;
+    base.part = esp_ota_get_running_partition();
+    if (decoder == nullptr || sink == nullptr) {
+      delete decoder;
+      delete sink;
+      return OTA_SVC_NO_MEMORY;
+    }
+
+    // Sıralı yazımda sektörler yazıldıkça silinir (baştan tüm alanı silmez)
+#ifdef OTA_WITH_SEQUENTIAL_WRITES
+    esp_err_t err = esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &sink->handle);
+#else
+    esp_err_t err = esp_ota_begin(target, OTA_SIZE_UNKNOWN, &sink->handle);
+#endif
+    if (err != ESP_OK) {
+      delete decoder;
+      delete sink;
+      return OTA_SVC_PARTITION;
+    }
+    mbedtls_sha256_init(&sink->sha);
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    mbedtls_sha256_starts(&sink->sha, 0);
+#else
+    mbedtls_sha256_starts_ret(&sink->sha, 0);
+#endif
+
+    uint8_t code = OTA_OK;
+    if (!decoder->begin(_encoding, _delta, _windowBits, _lookaheadBits, _outSize, &base, sink)) {
+      code = decoder->error();
+    } else {
+      char ready[48];
+      snprintf(ready, sizeof(ready), "{\"ota\":\"ready\",\"window\":%lu}", (unsigned long)OTA_WINDOW_BYTES);
+      notifyControl(_peerConnId, ready);
+      Serial.print("[OTA] begin size=");
+      Serial.print(_size);
+      Serial.print(" out=");
+      Serial.print(_outSize);
+      Serial.print(" enc=");
+      Serial.print(_encoding);
+      Serial.print(" delta=");
+      Serial.println(_delta ? 1 : 0);
+      code = pump(decoder);
+    }
+
+    uint8_t digest[32];
+#if ESP_ARDUINO_VERSION_MAJOR >= 3
+    mbedtls_sha256_finish(&sink->sha, digest);
+#else
+    mbedtls_sha256_finish_ret(&sink->sha, digest);
+#endif
+    mbedtls_sha256_free(&sink->sha);
+
+    if (code == OTA_OK && memcmp(digest, _expectedSha, sizeof(digest)) != 0) {
+      code = OTA_SVC_HASH;
+    }
+    if (code == OTA_OK) {
+      // esp_ota_end ayrıca görüntü başlığını/checksum'ını doğrular
+      if (esp_ota_end(sink->handle) != ESP_OK || esp_ota_set_boot_partition(target) != ESP_OK) {
+        code = OTA_SVC_PARTITION;
+      }
+    } else {
+      esp_ota_abort(sink->handle);
+    }
+
+    if (code == OTA_OK) {
+      uint32_t ms = millis() - _startMs;
+      uint32_t peakRam = _heapBefore - _heapMin;
+      char done[80];
+      snprintf(done, sizeof(done), "{\"ota\":\"done\",\"ms\":%lu,\"ram\":%lu}",
+               (unsigned long)ms, (unsigned long)peakRam);
+      notifyControl(_peerConnId, done);
+      Serial.print("[OTA] done rx=");
+      Serial.print(_size);
+      Serial.print(" out=");
+      Serial.print(_outSize);
+      Serial.print(" ms=");
+      Serial.print(ms);
+      Serial.print(" kbps=");
+      Serial.print(ms > 0 ? (unsigned long)((uint64_t)_size * 8 / ms) : 0UL);
+      Serial.print(" peak_ram=");
+      Serial.println(peakRam);
+    }
+    delete decoder;
+    delete sink;
+    return code;
+  }
+
+  // Stream buffer'dan oku, çöz, ack gönder
+  uint8_t pump(OtaDecoder* decoder) {
+    uint8_t buf[OTA_RX_CHUNK];
+    uint32_t consumed = 0;
+    uint32_t lastAck = 0;
+    uint32_t lastRxMs = millis();
+    while (consumed < _size) {
+      if (_abort) {
+        return OTA_SVC_ABORTED;
+      }
+      if (_overrun) {
+        return OTA_SVC_OVERRUN;
+      }
+      size_t want = _size - consumed;
+      if (want > sizeof(buf)) {
+        want = sizeof(buf);
+      }
+      size_t n = xStreamBufferReceive(_stream, buf, want, pdMS_TO_TICKS(100));
+      if (n == 0) {
+        // App sustu ama bağlantı açık kaldı: sonsuza kadar bekleme
+        if (millis() - lastRxMs >= OTA_IDLE_TIMEOUT_MS) {
+          return OTA_SVC_TIMEOUT;
+        }
+        continue;
+      }
+      lastRxMs = millis();
+      if (!decoder->feed(buf, n)) {
+        return decoder->error();
+      }
+      consumed += n;
+      sampleHeap();
+      if (consumed - lastAck >= OTA_ACK_BYTES || consumed == _size) {
+        char ack[48];
+        snprintf(ack, sizeof(ack), "{\"ota\":\"ack\",\"rx\":%lu}", (unsigned long)consumed);
+        notifyControl(_peerConnId, ack);
+        lastAck = consumed;
+      }
+    }
+    if (!decoder->finish()) {
+      return decoder->error();
+    }
+    return OTA_OK;
+  }
+
+  static bool parseHex(const char* hex, uint8_t* out, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+      int hi = hexDigit(hex[2 * i]);
+      int lo = hexDigit(hex[2 * i + 1]);
+      if (hi < 0 || lo < 0) {
+        return false;
+      }
+      out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return true;
+  }
+
+  static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  class ControlCallbacks : public BLECharacteristicCallbacks {
+    OtaService* _service;
+  public:
+    ControlCallbacks(OtaService* service) : _service(service) {}
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t* param) {
+      auto value = pCharacteristic->getValue();  // std::string (2.x) / String (3.x)
+      _service->onControl(param->write.conn_id, value.c_str());
+    }
+  };
+
+  // Büyük MTU'lu veri parçaları: getValue() kopyası yerine ham parametre kullanılır
+  class DataCallbacks : public BLECharacteristicCallbacks {
+    OtaService* _service;
+  public:
+    DataCallbacks(OtaService* service) : _service(service) {}
+    void onWrite(BLECharacteristic* pCharacteristic, esp_ble_gatts_cb_param_t* param) {
+      _service->onData(param->write.conn_id, param->write.value, param->write.len);
+    }
+  };
+};
+
+#endif // OTA_SERVICE_H
@@ -0,0 +1,232 @@
+#ifndef SERIAL_FRAME_H
+#define SERIAL_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* =========================================================
+   SERIAL FRAME (Makine Modu İkili Protokolü)
+   =========================================================
+
+   Test rig'i (Linux host) ile USB-CDC / UART üzerinden ikili
+   haberleşme. Her frame:
+
+     ham:   [type u8][seq u8][payload ...][crc16 u16 LE]
+     hatta: 0x00 COBS(ham) 0x00
+
+   CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) type..payload
+   üzerinden hesaplanır. COBS sayesinde 0x00 sadece ayraçtır; baştaki
+   ayraç araya karışan metin loglarını (ör. [BOOT]) ayrı, CRC'si
+   tutmayan bir "frame"de bırakır, gerçek frame bozulmaz.
+
+   seq: Host komutunun sırası; cevap frame'lerinde aynen döner.
+   Cihazın kendiliğinden gönderdiği frame'lerde (EVENT) 0'dır.
+   Çok byte'lı alanlar little endian.
+
+   Cihaz ve host aracı (tools/serial-rig) aynı dosyayı kullanır;
+   Arduino bağımlılığı yoktur.
+*/
+
+static const uint8_t SERIAL_PROTOCOL_VERSION = 1;
+static const size_t FRAME_MAX_PAYLOAD = 512;   // En uzun: TEXT (tanılama JSON'u)
+static const size_t FRAME_MAX_RAW = FRAME_MAX_PAYLOAD + 4;
+static const size_t FRAME_MAX_ENCODED = FRAME_MAX_RAW + FRAME_MAX_RAW / 254 + 1 + 2;
+
+enum FrameType : uint8_t {
+  // Cihaz -> host
+  FRAME_EVENT = 0x01,  // type, main, sub, v, ts u32, seq u32
+  FRAME_STATE = 0x02,  // main, sub, flags, dwell u16, ts u32, seq u32, rx_err u32, tx_drop u32
+  FRAME_ACK   = 0x03,  // cmd, status
+  FRAME_HELLO = 0x04,  // version, max payload u16
+  FRAME_TEXT  = 0x05,  // UTF-8 metin (ör. {"stall":{...}})
+
+  // Host -> cihaz
+  CMD_HELLO  = 0x81,   // Makine moduna geç (cevap: HELLO)
+  CMD_EXIT   = 0x82,   // Metin moduna dön (cevap: ACK)
+  CMD_INJECT = 0x83,   // input u8, delta i8, count u8 (cevap yok; kuyruk doluysa ACK hata)
+  CMD_STATE  = 0x84,   // Durum sorgusu (cevap: STATE)
+  CMD_STALL  = 0x85,   // op u8: 1 sorgu, 0 sıfırla (cevap: TEXT)
+  CMD_SETTLE = 0x86    // dwell u16 ms (cevap: ACK)
+};
+
+enum FrameStatus : uint8_t {
+  FRAME_OK = 0,
+  FRAME_ERR_QUEUE_FULL = 1,
+  FRAME_ERR_BAD_ARG = 2,
+  FRAME_ERR_UNKNOWN = 3
+};
+
+// STATE frame'indeki flags bitleri
+static const uint8_t STATE_FLAG_AI = 0x01;
+static const uint8_t STATE_FLAG_SUB_SW = 0x02;
+static const uint8_t STATE_FLAG_SETTLE_PENDING = 0x04;
+
+class SerialFrame {
+public:
+  static uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < len; i++) {
+      crc ^= (uint16_t)data[i] << 8;
+      for (uint8_t b = 0; b < 8; b++) {
+        crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+      }
+    }
+    return crc;
+  }
+
+  // COBS kodla (çıktıda 0x00 yok). out en az len + len / 254 + 1 byte olmalı
+  static size_t cobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t codePos = 0;
+    size_t o = 1;
+    uint8_t code = 1;
+    for (size_t i = 0; i < len; i++) {
+      if (in[i] == 0) {
+        out[codePos] = code;
+        codePos = o++;
+        code = 1;
+        continue;
+      }
+      out[o++] = in[i];
+      if (++code == 0xFF) {
+        out[codePos] = code;
+        codePos = o++;
+        code = 1;
+      }
+    }
+    out[codePos] = code;
+    return o;
+  }
+
+  // COBS çöz. Hatalı kodlamada 0 döner (boş frame de 0)
+  static size_t cobsDecode(const uint8_t* in, size_t len, uint8_t* out, size_t outSize) {
+    size_t i = 0;
+    size_t o = 0;
+    while (i < len) {
+      uint8_t code = in[i++];
+      if (code == 0 || i + code - 1 > len) {
+        return 0;
+      }
+      for (uint8_t k = 1; k < code; k++) {
+        if (o >= outSize) {
+          return 0;
+        }
+        out[o++] = in[i++];
+      }
+      // 0xFF bloğu sıfır taşımaz; son blok da sıfır eklemez
+      if (code != 0xFF && i < len) {
+        if (o >= outSize) {
+          return 0;
+        }
+        out[o++] = 0;
+      }
+    }
+    return o;
+  }
+
+  // Frame'i kur: CRC ekle, COBS kodla, iki ayraçla out'a yaz. Uzunluğu döndürür (taşarsa 0)
+  static size_t build(uint8_t type, uint8_t seq, const uint8_t* payload, size_t len, uint8_t* out) {
+    if (len > FRAME_MAX_PAYLOAD) {
+      return 0;
+    }
+    uint8_t raw[FRAME_MAX_RAW];
+    raw[0] = type;
+    raw[1] = seq;
+    if (len > 0) {
+      memcpy(raw + 2, payload, len);
+    }
+    uint16_t crc = crc16(raw, len + 2);
+    putU16(raw + len + 2, crc);
+    out[0] = 0;
+    size_t n = cobsEncode(raw, len + 4, out + 1);
+    out[n + 1] = 0;
+    return n + 2;
+  }
+
+  static void putU16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+  }
+
+  static void putU32(uint8_t* p, uint32_t v) {
+    for (uint8_t i = 0; i < 4; i++) {
+      p[i] = (uint8_t)(v >> (8 * i));
+    }
+  }
+
+  static uint16_t getU16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+  }
+
+  static uint32_t getU32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+  }
+};
+
+/* Byte akışından frame çıkarır. İlk 0x00 görülene kadar (senkron
+   değilken) gelen byte'lar frame'e alınmaz; çağıran bunları metin
+   olarak yorumlayabilir (push() false, synced() false). */
+class FrameReader {
+public:
+  // Bir byte işle. CRC'si doğru bir frame tamamlandıysa true
+  bool push(uint8_t b) {
+    if (b == 0) {
+      bool ok = _synced && _len > 0 && decode();
+      _synced = true;
+      _len = 0;
+      return ok;
+    }
+    if (!_synced) {
+      return false;
+    }
+    if (_len >= sizeof(_buf)) {
+      // Ayraçsız çok uzun veri: sonraki 0x00'a kadar at
+      _errors++;
+      _synced = false;
+      _len = 0;
+      return false;
+    }
+    _buf[_len++] = b;
+    return false;
+  }
+
+  bool synced() const { return _synced; }
+  // Ayraçtan sonra biriken (henüz tamamlanmamış) byte sayısı
+  size_t pending() const { return _len; }
+
+  // Yeni frame için tekrar baştaki 0x00'ı bekle
+  void unsync() {
+    _synced = false;
+    _len = 0;
+  }
+
+  uint8_t type() const { return _frame[0]; }
+  uint8_t seq() const { return _frame[1]; }
+  const uint8_t* payload() const { return _frame + 2; }
+  size_t payloadLen() const { return _frameLen - 4; }
+  uint32_t errors() const { return _errors; }
+
+private:
+  uint8_t _buf[FRAME_MAX_ENCODED];
+  uint8_t _frame[FRAME_MAX_RAW];
+  size_t _len = 0;
+  size_t _frameLen = 0;
+  bool _synced = false;
+  uint32_t _errors = 0;   // CRC / kodlama hatası, taşma
+
+  bool decode() {
+    size_t n = SerialFrame::cobsDecode(_buf, _len, _frame, sizeof(_frame));
+    if (n < 4) {
+      _errors++;
+      return false;
+    }
+    uint16_t crc = SerialFrame::getU16(_frame + n - 2);
+    if (SerialFrame::crc16(_frame, n - 2) != crc) {
+      _errors++;
+      return false;
+    }
+    _frameLen = n;
+    return true;
+  }
+};
+
+#endif // SERIAL_FRAME_H
@@ -0,0 +1,330 @@
+#ifndef STALL_MONITOR_H
+#define STALL_MONITOR_H
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include "BootProfile.h"
+
+/* =========================================================
+   STALL MONITOR (Ana Döngü Takılma Ölçümü)
+   =========================================================
+
+   loop()'un her aşamasının (encoder, buton, gönderim, BLE
+   bakımı...) süresini micros() ile ölçer. Bir tur bütçeyi
+   (varsayılan 5ms) aşarsa "stall" sayılır ve o turda en çok
+   zaman harcayan aşamaya yazılır. Aşama başına sayaç ve en
+   uzun süre, ayrıca en kötü STALL_WORST_SAMPLES tur tutulur.
+
+   Aşamalar iç içe girebilir: enter() bir önceki aşamayı
+   döndürür, sendEvent() gibi ortak kod kendi aşamasına girip
+   çıkışta eskisine döner. "outside" iki loop() çağrısı
+   arasında geçen süredir (Arduino loopTask, öncelik kaybı).
+
+   Watchdog: loopTask task watchdog'a eklenir (enableLoopWDT).
+   Son girilen aşama RTC_NOINIT bellekte tutulur; watchdog
+   tetiklenirse (ISR) veya cihaz WDT ile resetlenirse hangi
+   aşamada takıldığı raporlanır.
+
+   Log formatı (log analizi için sabit tutun):
+   [STALL] loop=7421us budget=5000us stage=send stage_us=6900 t=12345ms
+   [STALL] stats loops=120345 stalls=3 budget=5000us max=7421us wdt=0 encoder=0/84us ...
+   [STALL] worst loop=7421us stage=send stage_us=6900 t=12345ms
+   [STALL] reset=TASK_WDT last_stage=advertising
+*/
+
+enum LoopStage : uint8_t {
+  STAGE_OUTSIDE = 0,   // loop() çağrıları arası
+  STAGE_ENCODER,       // Encoder okuma ve rotate event'leri
+  STAGE_SETTLE,        // SETTLE dwell kontrolü
+  STAGE_BUTTONS,       // Buton okuma ve buton event'leri
+  STAGE_INJECT,        // Host'tan enjekte edilen girişler (Serial makine modu)
+  STAGE_SEND,          // sendEvent(): log + transport gönderimi
+  STAGE_ADVERTISING,   // Pairing / advertising durum bakımı
+  STAGE_CONNECTION,    // Bağlantı bakımı, saat senkronu
+  STAGE_DIAG,          // Stall raporu ve tanılama sorguları
+  STAGE_COUNT
+};
+
+static const uint32_t STALL_BUDGET_US_DEFAULT = 5000;  // Input yolu için hedef: birkaç ms
+static const uint32_t STALL_BUDGET_US_MIN = 500;
+static const uint32_t STALL_LOG_INTERVAL_MS = 1000;    // Stall log satırı en fazla saniyede bir
+static const uint8_t STALL_WORST_SAMPLES = 4;
+static const size_t STALL_JSON_MAX = 512;              // toJson tamponu (Serial frame payload'una sığar)
+static const uint32_t STALL_RTC_MAGIC = 0x5354414C;    // "STAL"
+
+// Reset sonrası okunabilmesi için RTC bellekte (açılışta sıfırlanmaz)
+RTC_NOINIT_ATTR static uint32_t stallRtcMagic;
+RTC_NOINIT_ATTR static uint8_t stallRtcStage;
+// Watchdog ISR'ının yakaladığı aşama ve tetiklenme sayısı
+static volatile uint8_t stallWdtStage = STAGE_OUTSIDE;
+static volatile uint32_t stallWdtHits = 0;
+
+// IDF task watchdog tetiklendiğinde çağrılır (weak hook, ISR bağlamı)
+extern "C" void IRAM_ATTR esp_task_wdt_isr_user_handler(void) {
+  stallWdtStage = stallRtcStage;
+  stallWdtHits++;
+}
+
+class StallMonitor {
+public:
+  struct Sample {
+    uint32_t loopUs;   // Turun toplam süresi
+    uint32_t stageUs;  // Suçlu aşamanın bu turdaki süresi
+    uint32_t atMs;     // millis()
+    uint8_t stage;
+  };
+
+  // Önceki reset WDT kaynaklıysa takılan aşamayı raporla, loop watchdog'unu aç
+  void begin(uint32_t budgetUs = STALL_BUDGET_US_DEFAULT) {
+    setBudget(budgetUs);
+    esp_reset_reason_t reason = esp_reset_reason();
+    bool wdtReset = reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT ||
+                    reason == ESP_RST_WDT || reason == ESP_RST_PANIC;
+    if (wdtReset && stallRtcMagic == STALL_RTC_MAGIC && stallRtcStage < STAGE_COUNT) {
+      Serial.print("[STALL] reset=");
+      Serial.print(BootProfile::resetName(reason));
+      Serial.print(" last_stage=");
+      Serial.println(stageName(stallRtcStage));
+    }
+    stallRtcMagic = STALL_RTC_MAGIC;
+    stallRtcStage = STAGE_OUTSIDE;
+
+    // loopTask her loop() sonrası watchdog'u besler; takılırsa ISR aşamayı yakalar
+    enableLoopWDT();
+    Serial.print("[STALL] Monitor aktif budget=");
+    Serial.print(_budgetUs);
+    Serial.println("us");
+  }
+
+  // Tur başlangıcı: önceki loop() bitişinden bu yana geçen süre "outside" aşamasına yazılır
+  void loopBegin() {
+    memset(_iterUs, 0, sizeof(_iterUs));
+    _cycleStart = _running ? _loopEnd : micros();
+    _stageStart = _cycleStart;
+    _stage = STAGE_OUTSIDE;
+  }
+
+  // Yeni aşamaya geç, bir öncekini döndür (iç içe kullanım için)
+  LoopStage enter(LoopStage stage) {
+    uint32_t now = micros();
+    LoopStage prev = _stage;
+    _iterUs[prev] += now - _stageStart;
+    _stageStart = now;
+    _stage = stage;
+    stallRtcStage = stage;
+    return prev;
+  }
+
+  // Tur sonu: bütçe aşıldıysa en çok zaman harcayan aşamaya yaz
+  void loopEnd() {
+    uint32_t now = micros();
+    _iterUs[_stage] += now - _stageStart;
+    _stage = STAGE_OUTSIDE;
+    stallRtcStage = STAGE_OUTSIDE;
+    uint32_t total = now - _cycleStart;
+    _loopEnd = now;
+    _running = true;
+    _loops++;
+
+    uint8_t culprit = STAGE_OUTSIDE;
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+      if (_iterUs[i] > _stageMaxUs[i]) {
+        _stageMaxUs[i] = _iterUs[i];
+      }
+      if (_iterUs[i] > _iterUs[culprit]) {
+        culprit = i;
+      }
+    }
+    if (total > _maxLoopUs) {
+      _maxLoopUs = total;
+    }
+    if (total <= _budgetUs) {
+      return;
+    }
+
+    _stalls++;
+    _stageStalls[culprit]++;
+    Sample s = { total, _iterUs[culprit], millis(), culprit };
+    insertWorst(s);
+    // Raporun kendisi (diag) yeni rapor doğurmasın: sayılır ama loglanmaz
+    if (culprit != STAGE_DIAG && (!_reportPending || total > _pending.loopUs)) {
+      _pending = s;
+      _reportPending = true;
+    }
+  }
+
+  // Bekleyen stall / watchdog raporunu bas (STAGE_DIAG içinde, hız sınırlı)
+  void report(Print& out) {
+    uint32_t hits = stallWdtHits;
+    if (hits != _seenWdtHits) {
+      _seenWdtHits = hits;
+      out.print("[STALL] wdt hits=");
+      out.print(hits);
+      out.print(" stage=");
+      out.println(stageName(stallWdtStage));
+    }
+    if (!_reportPending || (_lastReportMs != 0 && millis() - _lastReportMs < STALL_LOG_INTERVAL_MS)) {
+      return;
+    }
+    _reportPending = false;
+    _lastReportMs = millis();
+    out.print("[STALL] loop=");
+    out.print(_pending.loopUs);
+    out.print("us budget=");
+    out.print(_budgetUs);
+    out.print("us stage=");
+    out.print(stageName(_pending.stage));
+    out.print(" stage_us=");
+    out.print(_pending.stageUs);
+    out.print(" t=");
+    out.print(_pending.atMs);
+    out.println("ms");
+  }
+
+  // Tüm sayaçlar: tek özet satırı + en kötü turlar
+  void printStats(Print& out) const {
+    out.print("[STALL] stats loops=");
+    out.print(_loops);
+    out.print(" stalls=");
+    out.print(_stalls);
+    out.print(" budget=");
+    out.print(_budgetUs);
+    out.print("us max=");
+    out.print(_maxLoopUs);
+    out.print("us wdt=");
+    out.print((uint32_t)stallWdtHits);
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+      out.print(" ");
+      out.print(stageName(i));
+      out.print("=");
+      out.print(_stageStalls[i]);
+      out.print("/");
+      out.print(_stageMaxUs[i]);
+      out.print("us");
+    }
+    out.println();
+    for (uint8_t i = 0; i < _worstCount; i++) {
+      out.print("[STALL] worst loop=");
+      out.print(_worst[i].loopUs);
+      out.print("us stage=");
+      out.print(stageName(_worst[i].stage));
+      out.print(" stage_us=");
+      out.print(_worst[i].stageUs);
+      out.print(" t=");
+      out.print(_worst[i].atMs);
+      out.println("ms");
+    }
+  }
+
+  // Tanılama sorgusu cevabı (app'e notify): {"stall":{...}}
+  // Sığmayan aşama / worst öğeleri bütün olarak atlanır; kapanış için yer
+  // ayrıldığından kesilen çıktı da geçerli JSON'dur. Başlık sığmazsa 0 döner.
+  int toJson(char* buf, size_t size) const {
+    const int limit = (int)size - 5;  // "]}}\n" + '\0'
+    int len = snprintf(buf, size,
+                       "{\"stall\":{\"loops\":%lu,\"stalls\":%lu,\"budget_us\":%lu,\"max_us\":%lu,\"wdt\":%lu,\"stages\":{",
+                       (unsigned long)_loops, (unsigned long)_stalls, (unsigned long)_budgetUs,
+                       (unsigned long)_maxLoopUs, (unsigned long)stallWdtHits);
+    if (len < 0 || len > limit) {
+      if (size > 0) {
+        buf[0] = '\0';
+      }
+      return 0;
+    }
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+      int n = snprintf(buf + len, size - len, "%s\"%s\":[%lu,%lu]", i == 0 ? "" : ",",
+                       stageName(i), (unsigned long)_stageStalls[i], (unsigned long)_stageMaxUs[i]);
+      if (n < 0 || len + n > limit) {
+        break;
+      }
+      len += n;
+    }
+    bool worstOpen = false;
+    for (uint8_t i = 0; i < _worstCount; i++) {
+      int n = snprintf(buf + len, size - len, "%s{\"us\":%lu,\"stage\":\"%s\",\"t\":%lu}",
+                       i == 0 ? "},\"worst\":[" : ",", (unsigned long)_worst[i].loopUs,
+                       stageName(_worst[i].stage), (unsigned long)_worst[i].atMs);
+      if (n < 0 || len + n > limit) {
+        break;
+      }
+      len += n;
+      worstOpen = true;
+    }
+    len += snprintf(buf + len, size - len, worstOpen ? "]}}\n" : "}}}\n");
+    return len;
+  }
+
+  void setBudget(uint32_t budgetUs) {
+    _budgetUs = budgetUs < STALL_BUDGET_US_MIN ? STALL_BUDGET_US_MIN : budgetUs;
+  }
+
+  uint32_t budgetUs() const { return _budgetUs; }
+
+  // Sayaçları sıfırla (bütçe korunur)
+  void reset() {
+    _loops = 0;
+    _stalls = 0;
+    _maxLoopUs = 0;
+    _worstCount = 0;
+    _reportPending = false;
+    memset(_stageStalls, 0, sizeof(_stageStalls));
+    memset(_stageMaxUs, 0, sizeof(_stageMaxUs));
+  }
+
+  static const char* stageName(uint8_t stage) {
+    switch (stage) {
+      case STAGE_OUTSIDE:     return "outside";
+      case STAGE_ENCODER:     return "encoder";
+      case STAGE_SETTLE:      return "settle";
+      case STAGE_BUTTONS:     return "buttons";
+      case STAGE_INJECT:      return "inject";
+      case STAGE_SEND:        return "send";
+      case STAGE_ADVERTISING: return "advertising";
+      case STAGE_CONNECTION:  return "connection";
+      case STAGE_DIAG:        return "diag";
+      default:                return "unknown";
+    }
+  }
+
+private:
+  uint32_t _budgetUs = STALL_BUDGET_US_DEFAULT;
+  uint32_t _iterUs[STAGE_COUNT] = {0};      // Bu turdaki aşama süreleri
+  uint32_t _stageMaxUs[STAGE_COUNT] = {0};  // Aşamanın tek turdaki en uzun süresi
+  uint32_t _stageStalls[STAGE_COUNT] = {0}; // Aşamaya yazılan stall sayısı
+  uint32_t _cycleStart = 0;
+  uint32_t _stageStart = 0;
+  uint32_t _loopEnd = 0;
+  uint32_t _loops = 0;
+  uint32_t _stalls = 0;
+  uint32_t _maxLoopUs = 0;
+  uint32_t _lastReportMs = 0;
+  uint32_t _seenWdtHits = 0;
+  LoopStage _stage = STAGE_OUTSIDE;
+  bool _running = false;
+  bool _reportPending = false;
+  Sample _pending = {0, 0, 0, STAGE_OUTSIDE};
+  Sample _worst[STALL_WORST_SAMPLES];
+  uint8_t _worstCount = 0;
+
+  // En kötü turları azalan sırada tut
+  void insertWorst(const Sample& s) {
+    uint8_t pos = _worstCount;
+    while (pos > 0 && _worst[pos - 1].loopUs < s.loopUs) {
+      pos--;
+    }
+    if (pos >= STALL_WORST_SAMPLES) {
+      return;
+    }
+    uint8_t last = _worstCount < STALL_WORST_SAMPLES ? _worstCount : STALL_WORST_SAMPLES - 1;
+    for (uint8_t i = last; i > pos; i--) {
+      _worst[i] = _worst[i - 1];
+    }
+    _worst[pos] = s;
+    if (_worstCount < STALL_WORST_SAMPLES) {
+      _worstCount++;
+    }
+  }
+};
+
+#endif // STALL_MONITOR_H
@@ -34,6 +34,9 @@
 #define TRANSPORT_BLE   // Gerçek cihaz için
 
 #include "EventTransport.h"
+#include "BootProfile.h"
+#include "Feedback.h"
+#include "StallMonitor.h"
 #include "pin.h"
 
 #ifdef TRANSPORT_BLE
@@ -88,10 +91,15 @@ public:
     : _clk(clk), _dt(dt), _lastClk(HIGH), _lastDt(HIGH), _lastReadTime(0) {}
 
   // begin(): Pin'leri INPUT_PULLUP olarak ayarlar ve başlangıç durumunu okur
+  // Sabit bekleme yok: setup() pin'ler stabil okunana kadar bekler, sonra sync() çağırır
   void begin() {
     pinMode(_clk, INPUT_PULLUP);  // CLK pin'ini pull-up ile input yap
     pinMode(_dt, INPUT_PULLUP);   // DT pin'ini pull-up ile input yap
-    delay(10);                     // Pin'lerin stabilize olması için bekle
+    sync();
+  }
+
+  // sync(): Mevcut pin durumunu referans olarak kaydet (edge detection başlangıcı)
+  void sync() {
     _lastClk = digitalRead(_clk);  // Başlangıç CLK durumunu kaydet
     _lastDt = digitalRead(_dt);    // Başlangıç DT durumunu kaydet
     _lastReadTime = millis();      // Başlangıç zamanını kaydet
@@ -150,6 +158,99 @@ private:
 Encoder encMain (PIN_MAIN_CLK,  PIN_MAIN_DT);  // Ana menü encoder'ı
 Encoder encSub  (PIN_SUB_CLK,   PIN_SUB_DT);   // Alt menü encoder'ı
 
+/* ============================================================================
+ * ROTATION VELOCITY (Dönüş Hızı İpucu)
+ * ============================================================================
+ *
+ * Her encoder adımının zamanını izler (rate limit'e takılan adımlar dahil)
+ * ve adımlar arası sürenin yumuşatılmış ortalamasından hız çıkarır.
+ * Rotate event'lerine "v" (adım/sn) olarak eklenir; app hızlı çevirmede
+ * ara öğeleri seslendirmeyi atlayabilir.
+ *
+ * VELOCITY_IDLE_MS'den uzun duraklamadan sonraki ilk adım v=0 (tek adım) verir.
+ */
+class RotationVelocity {
+public:
+  // Yeni adım kaydet ve güncel hızı döndür (adım/sn, 0-255)
+  uint8_t step(uint32_t now) {
+    uint32_t dt = now - _lastStepTime;
+    _lastStepTime = now;
+    if (!_active || dt >= VELOCITY_IDLE_MS) {
+      _active = true;
+      _intervalMs = 0;
+      return 0;
+    }
+    if (dt == 0) {
+      dt = 1;
+    }
+    // Üstel ortalama (yeni adım ağırlığı 1/2): hızlanma/yavaşlama birkaç adımda yansır
+    _intervalMs = (_intervalMs == 0) ? dt : (_intervalMs + dt) / 2;
+    uint32_t v = 1000 / _intervalMs;
+    return v > 255 ? 255 : (uint8_t)v;
+  }
+
+  // Son adımın zamanı (dwell takibi için)
+  uint32_t lastStepTime() const { return _lastStepTime; }
+
+private:
+  static const uint32_t VELOCITY_IDLE_MS = 500;
+  bool _active = false;
+  uint32_t _lastStepTime = 0;
+  uint32_t _intervalMs = 0;
+};
+
+RotationVelocity velMain;
+RotationVelocity velSub;
+
+// Açılış aşamalarının zaman ölçümü (cold boot / wake -> ilk event)
+BootProfile bootProfile;
+
+// Ana döngü aşama süreleri ve takılma (stall) tespiti
+StallMonitor stallMonitor;
+
+/* ============================================================================
+ * waitForStableInputs() - Pin Stabilizasyonu
+ * ============================================================================
+ *
+ * Sabit delay() yerine tüm input pin'lerini örnekler ve okunan değerler
+ * INPUT_STABLE_US boyunca değişmeyene kadar bekler. Pull-up'lar genelde
+ * birkaç µs içinde oturur; süre INPUT_STABLE_TIMEOUT_US ile sınırlıdır
+ * (örneğin açılışta basılı tutulan veya zıplayan bir kontak için).
+ *
+ * Return: Stabilizasyon için geçen süre (µs)
+ */
+static const uint32_t INPUT_STABLE_US = 500;           // Bu süre boyunca değişmemeli
+static const uint32_t INPUT_STABLE_TIMEOUT_US = 20000; // En fazla 20ms bekle
+
+uint32_t waitForStableInputs() {
+  static const uint8_t pins[] = {
+    PIN_MAIN_CLK, PIN_MAIN_DT, PIN_SUB_CLK, PIN_SUB_DT, PIN_SUB_SW, PIN_AI
+  };
+  const uint8_t pinCount = sizeof(pins) / sizeof(pins[0]);
+
+  uint32_t start = micros();
+  uint32_t stableSince = start;
+  uint8_t last = 0;
+  for (uint8_t i = 0; i < pinCount; i++) {
+    last |= (digitalRead(pins[i]) == HIGH ? 1 : 0) << i;
+  }
+
+  while (true) {
+    uint32_t now = micros();
+    uint8_t current = 0;
+    for (uint8_t i = 0; i < pinCount; i++) {
+      current |= (digitalRead(pins[i]) == HIGH ? 1 : 0) << i;
+    }
+    if (current != last) {
+      last = current;
+      stableSince = now;  // Değişim oldu, pencereyi yeniden başlat
+    }
+    if (now - stableSince >= INPUT_STABLE_US || now - start >= INPUT_STABLE_TIMEOUT_US) {
+      return now - start;
+    }
+  }
+}
+
 /* ============================================================================
  * EVENT TRANSPORT (Event Taşıma Katmanı)
  * ============================================================================
@@ -159,12 +260,15 @@ Encoder encSub  (PIN_SUB_CLK,   PIN_SUB_DT);   // Alt menü encoder'ı
  * 
  * Event Transport Pattern: Farklı taşıma yöntemlerini aynı interface ile kullanır
  */
+// LED / titreşim geri bildirimi (transport'lar kullanır, loop'ta zaman harcamaz)
+FeedbackEngine feedback(PIN_LED);
+
 #ifdef TRANSPORT_SERIAL
 // Simülasyon modu: Serial port üzerinden log (Wokwi için)
-SerialEventTransport eventTransport(PIN_LED);
+SerialEventTransport eventTransport(feedback);
 #else
 // Gerçek cihaz modu: BLE üzerinden gönderim
-BLEEventTransport eventTransport(PIN_LED);
+BLEEventTransport eventTransport(feedback);
 #endif
 
 /* ============================================================================
@@ -177,6 +281,7 @@ BLEEventTransport eventTransport(PIN_LED);
  * - type: Event türü (MAIN_ROTATE, SUB_ROTATE, CONFIRM, AI_PRESS, AI_RELEASE)
  * - m: mainIndex (ana menü pozisyonu, opsiyonel, varsayılan 0)
  * - s: subIndex (alt menü pozisyonu, opsiyonel, varsayılan 0)
+ * - v: Dönüş hızı (adım/sn, sadece rotate event'lerinde, varsayılan 0)
  * 
  * Event yapısı:
  * - type: Hangi olay olduğu (döndürme, buton basma, vb.)
@@ -184,28 +289,184 @@ BLEEventTransport eventTransport(PIN_LED);
  * - subIndex: Hangi alt menü öğesinde
  * - ts: Timestamp (millis() - olayın zamanı)
  */
-void sendEvent(EventType type, uint8_t m = 0, uint8_t s = 0) {
+void sendEvent(EventType type, uint8_t m = 0, uint8_t s = 0, uint8_t v = 0) {
   Event event;                    // Event yapısı oluştur
   event.type = type;              // Event türünü ayarla
   event.mainIndex = m;            // Ana menü pozisyonunu ayarla
   event.subIndex = s;            // Alt menü pozisyonunu ayarla
   event.ts = millis();           // Zaman damgası ekle (milisaniye cinsinden)
+  event.velocity = v;            // Dönüş hızı ipucu
+
+  // Log + transport süresi çağıran aşamadan ayrı ölçülür
+  LoopStage prevStage = stallMonitor.enter(STAGE_SEND);
+  bootProfile.mark(BOOT_FIRST_EVENT); // Sadece ilk event'te kaydedilir
   
-  // Event gönderim log'u
-  Serial.print("[DEBUG] sendEvent çağrıldı: type=");
-  Serial.print(type);
-  Serial.print(" m=");
-  Serial.print(m);
-  Serial.print(" s=");
-  Serial.print(s);
-  Serial.print(" ts=");
-  Serial.println(event.ts);
+  // Event gönderim log'u (Serial makine modunda çıktı ikili frame'dir, log basılmaz)
+  bool verbose = !eventTransport.isMachineMode();
+  if (verbose) {
+    Serial.print("[DEBUG] sendEvent çağrıldı: type=");
+    Serial.print(type);
+    Serial.print(" m=");
+    Serial.print(m);
+    Serial.print(" s=");
+    Serial.print(s);
+    Serial.print(" ts=");
+    Serial.println(event.ts);
+  }
   
   eventTransport.sendEvent(event); // Event'i gönder (Serial veya BLE)
   
-  Serial.println("[DEBUG] sendEvent tamamlandı");
+  if (verbose) {
+    Serial.println("[DEBUG] sendEvent tamamlandı");
+  }
+  stallMonitor.enter(prevStage);
 }
 
+/* ============================================================================
+ * GLOBAL BUTON STATE (Global Buton Durum Değişkenleri)
+ * ============================================================================
+ * 
+ * Butonların basılı olup olmadığını takip eden flag'ler.
+ * Edge detection için kullanılır: Sadece basıldığında event gönderilir,
+ * basılı tutulduğunda tekrar event gönderilmez.
+ * 
+ * static: Fonksiyon dışında erişilebilir ama global scope'u kirletmez
+ */
+static bool aiPressed = false;     // AI butonu basılı mı?
+static bool subSwPressed = false;   // Sub Menu Switch basılı mı?
+
+// Buton bırakıldıktan sonra bounce'u önlemek için zaman takibi
+static uint32_t lastAiReleaseTime = 0;      // AI butonu son bırakılma zamanı
+static uint32_t lastSubSwReleaseTime = 0;   // SubSW butonu son bırakılma zamanı
+static const uint32_t BUTTON_RELEASE_DEBOUNCE_MS = 100; // Buton bırakıldıktan sonra 100ms bekle
+
+// AI butonu artık sadece bas-konuş için kullanılıyor
+// Pairing mode cihaz açılışında otomatik başlatılıyor
+
+// Encoder event gönderimi için rate limiting
+static uint32_t lastMainRotateTime = 0;     // Son ana menü rotate event zamanı
+static uint32_t lastSubRotateTime = 0;      // Son alt menü rotate event zamanı
+static const uint32_t EVENT_RATE_LIMIT_MS = 100; // Minimum event gönderim aralığı (100ms)
+
+// SETTLE: Son rotate event'inden sonra pozisyon dwell süresi boyunca değişmezse bir kez gönderilir.
+// Dwell süresi transport'tan okunur (app ayarlayabilir). CONFIRM / AI_PRESS bekleyen SETTLE'ı iptal eder.
+static bool settlePending = false;
+
+/* ============================================================================
+ * handleDiagnostics() - Stall Raporu ve Tanılama Sorguları
+ * ============================================================================
+ *
+ * Bekleyen stall satırını basar (saniyede en fazla bir) ve app'ten
+ * ({"stall":1}) veya Serial'den ('?' / CMD_STALL) gelen sorguya sayaçlarla
+ * cevap verir. Serial makine modunda metin basılmaz, cevap frame ile gider.
+ */
+void handleDiagnostics() {
+  bool verbose = !eventTransport.isMachineMode();
+  if (verbose) {
+    stallMonitor.report(Serial);
+  }
+
+  DiagRequest req;
+  if (!eventTransport.takeDiagRequest(&req)) {
+    return;
+  }
+  if (req.cmd == DIAG_STATE_QUERY) {
+    DeviceState state = { (uint8_t)mainIndex, (uint8_t)subIndex, aiPressed, subSwPressed, settlePending };
+    eventTransport.sendState(state);
+    return;
+  }
+  if (req.cmd == DIAG_STALL_RESET) {
+    stallMonitor.reset();
+    if (verbose) {
+      Serial.println("[STALL] Sayaçlar sıfırlandı");
+    }
+  } else if (req.cmd == DIAG_STALL_BUDGET) {
+    stallMonitor.setBudget(req.value);
+    if (verbose) {
+      Serial.print("[STALL] budget=");
+      Serial.print(stallMonitor.budgetUs());
+      Serial.println("us");
+    }
+  }
+  if (verbose) {
+    stallMonitor.printStats(Serial);
+  }
+
+  static_assert(STALL_JSON_MAX <= FRAME_MAX_PAYLOAD, "stall JSON tek Serial frame'e sığmalı");
+  char json[STALL_JSON_MAX];
+  int len = stallMonitor.toJson(json, sizeof(json));
+  eventTransport.sendDiag(json, len);
+}
+
+/* ============================================================================
+ * GİRİŞ İŞLEYİCİLERİ (Input Handlers)
+ * ============================================================================
+ *
+ * Fiziksel encoder/buton okuması (loop) ve host'tan enjekte edilen girişler
+ * (Serial makine modu, test rig'i) aynı işleyicilere gider. Fiziksel adımlarda
+ * rate limit uygulanır; enjekte adımlarda uygulanmaz (rig her adımın event'ini
+ * doğrular). Buton debounce'u loop'taki fiziksel okumada kalır.
+ */
+void handleMainStep(int8_t d, bool rateLimit) {
+  uint32_t now = millis();
+  uint8_t v = velMain.step(now);  // Hız: rate limit'e takılan adımlar da sayılır
+  // Rate limiting: Çok hızlı event gönderimini önle
+  if (rateLimit && now - lastMainRotateTime < EVENT_RATE_LIMIT_MS) {
+    return;
+  }
+  mainIndex += d;  // Pozisyonu güncelle (+1 veya -1)
+  // Ana menü değiştiğinde alt menüyü sıfırla
+  subIndex = 0;  // Alt menü sıfırla
+  // Event gönder: Ana menü değişti
+  sendEvent(MAIN_ROTATE, mainIndex, 0, v);
+  lastMainRotateTime = now;  // Son event zamanını güncelle
+  settlePending = true;
+}
+
+void handleSubStep(int8_t d, bool rateLimit) {
+  uint32_t now = millis();
+  uint8_t v = velSub.step(now);
+  // Rate limiting: Çok hızlı event gönderimini önle
+  if (rateLimit && now - lastSubRotateTime < EVENT_RATE_LIMIT_MS) {
+    return;
+  }
+  subIndex += d;  // Pozisyonu güncelle (+1 veya -1)
+  // Event gönder: Alt menü değişti
+  sendEvent(SUB_ROTATE, mainIndex, subIndex, v);
+  lastSubRotateTime = now;  // Son event zamanını güncelle
+  settlePending = true;
+}
+
+// AI butonu basıldı (bas-konuş başladı)
+void handleAiPress() {
+  settlePending = false;  // Kullanıcı zaten karar verdi
+  sendEvent(AI_PRESS, mainIndex, subIndex);
+}
+
+// AI butonu bırakıldı (bas-konuş sona erdi)
+void handleAiRelease() {
+  sendEvent(AI_RELEASE, mainIndex, subIndex);
+}
+
+// Alt menü switch'i basıldı (onay işlemi)
+void handleConfirm() {
+  settlePending = false;  // Kullanıcı zaten karar verdi
+  sendEvent(CONFIRM, mainIndex, subIndex);
+}
+
+// Host'tan gelen giriş (buton state'lerine dokunmaz, fiziksel okumayı bozmaz)
+static const uint8_t INJECT_MAX_PER_LOOP = 16;  // Tur başına en fazla enjekte adım
+
+void applyInjectedInput(const InjectedInput& input) {
+  switch (input.kind) {
+    case INJECT_MAIN_STEP:  handleMainStep(input.delta, false); break;
+    case INJECT_SUB_STEP:   handleSubStep(input.delta, false); break;
+    case INJECT_AI_PRESS:   handleAiPress(); break;
+    case INJECT_AI_RELEASE: handleAiRelease(); break;
+    case INJECT_CONFIRM:    handleConfirm(); break;
+    default: break;
+  }
+}
 
 /* ============================================================================
  * SETUP() - Başlangıç Fonksiyonu
@@ -213,14 +474,20 @@ void sendEvent(EventType type, uint8_t m = 0, uint8_t s = 0) {
  * 
  * Arduino'da program başladığında bir kez çalışır.
  * Pin'leri, encoder'ları ve butonları başlatır.
+ *
+ * Sıralama: Önce input yakalama hazırlanır (pin'ler stabil okunana kadar),
+ * BLE en son ve arka planda başlatılır. Böylece kullanıcı cihazı açar açmaz
+ * encoder/buton olayları kaybolmaz; BLE hazır olunca event'ler iletilir.
  */
 void setup() {
   // Serial port'u başlat (115200 baud rate - hızlı veri aktarımı)
   Serial.begin(115200);
+  bootProfile.begin();
+  // Önceki reset watchdog kaynaklıysa takılan aşamayı raporla, loop WDT'yi aç
+  stallMonitor.begin();
 
-  // LED pin'ini OUTPUT olarak ayarla ve başlangıçta söndür
-  pinMode(PIN_LED, OUTPUT);
-  digitalWrite(PIN_LED, LOW);
+  // LED (ve varsa titreşim motoru / NeoPixel) çıkışlarını hazırla, başlangıçta kapalı
+  feedback.begin();
 
   // Buton pin'lerini INPUT_PULLUP olarak ayarla
   // Pull-up: Pin'e dahili direnç bağlı, basılı değilken HIGH, basılıyken LOW
@@ -232,44 +499,33 @@ void setup() {
   encSub.begin();   // Alt menü encoder'ı
 
   // Buton durumlarını stabilize et (ilk okumalarda yanlış tetiklenmeyi önle)
-  delay(100);
+  // Sabit bekleme yerine pin'ler gerçekten stabil okunana kadar beklenir
+  uint32_t settleUs = waitForStableInputs();
+  encMain.sync();
+  encSub.sync();
+
+  // Başlangıç buton durumları
+  // AI: Her zaman false ile başla (basılı açılışta ilk okumada AI_PRESS gider)
+  // SubSW: Açılışta basılıysa bırakılana kadar CONFIRM gönderilmez
+  aiPressed = false;
+  lastAiReleaseTime = 0;
+  subSwPressed = (digitalRead(PIN_SUB_SW) == LOW);
+
+  bootProfile.mark(BOOT_INPUT_ARMED);
 
   // Başlangıç mesajı (Serial Monitor'de görünür)
-  Serial.println("[INIT] Pozisyon takibi aktif");
+  Serial.print("[INIT] Pozisyon takibi aktif (pin stabilizasyonu ");
+  Serial.print(settleUs);
+  Serial.println("us)");
   
   // Cihaz açıldığında otomatik olarak 15 saniye pairing mode başlat
+  // BLE arka planda başlar, setup() hemen döner
   Serial.println("[INIT] Otomatik pairing mode başlatılıyor (15 saniye)...");
   eventTransport.enablePairingMode();
+  bootProfile.mark(BOOT_BLE_STARTED);
   Serial.println("[INIT] Pairing mode başlatıldı");
 }
 
-/* ============================================================================
- * GLOBAL BUTON STATE (Global Buton Durum Değişkenleri)
- * ============================================================================
- * 
- * Butonların basılı olup olmadığını takip eden flag'ler.
- * Edge detection için kullanılır: Sadece basıldığında event gönderilir,
- * basılı tutulduğunda tekrar event gönderilmez.
- * 
- * static: Fonksiyon dışında erişilebilir ama global scope'u kirletmez
- */
-static bool aiPressed = false;     // AI butonu basılı mı?
-static bool subSwPressed = false;   // Sub Menu Switch basılı mı?
-static uint32_t loopCount = 0;     // Loop sayacı (ilk 10 loop'u atlamak için)
-
-// Buton bırakıldıktan sonra bounce'u önlemek için zaman takibi
-static uint32_t lastAiReleaseTime = 0;      // AI butonu son bırakılma zamanı
-static uint32_t lastSubSwReleaseTime = 0;   // SubSW butonu son bırakılma zamanı
-static const uint32_t BUTTON_RELEASE_DEBOUNCE_MS = 100; // Buton bırakıldıktan sonra 100ms bekle
-
-// AI butonu artık sadece bas-konuş için kullanılıyor
-// Pairing mode cihaz açılışında otomatik başlatılıyor
-
-// Encoder event gönderimi için rate limiting
-static uint32_t lastMainRotateTime = 0;     // Son ana menü rotate event zamanı
-static uint32_t lastSubRotateTime = 0;      // Son alt menü rotate event zamanı
-static const uint32_t EVENT_RATE_LIMIT_MS = 100; // Minimum event gönderim aralığı (100ms)
-
 /* ============================================================================
  * LOOP() - Ana Döngü Fonksiyonu
  * ============================================================================
@@ -279,28 +535,21 @@ static const uint32_t EVENT_RATE_LIMIT_MS = 100; // Minimum event gönderim aral
  * 1. Encoder'ları okur ve pozisyon değişikliklerini tespit eder
  * 2. Butonları okur ve basılma olaylarını tespit eder
  * 3. Her değişiklik için event gönderir
+ * 4. Host'tan enjekte edilen girişleri işler (Serial makine modu)
+ *
+ * Her aşama stallMonitor ile ölçülür; bir tur STALL_BUDGET_US_DEFAULT'u
+ * aşarsa en çok zaman harcayan aşamaya yazılır ve [STALL] ile loglanır.
  * 
  * ÖNEMLİ: Bu cihaz sadece pozisyon takibi yapar, menü içeriğini bilmez!
  */
 void loop() {
-  loopCount++;  // Loop sayacını artır
-  
-  // İlk 10 loop: Buton durumlarını stabilize et
-  // Bu, cihaz açıldığında butonların yanlış tetiklenmesini önler
-  if (loopCount < 10) {
-    // Butonların mevcut durumunu oku ve flag'leri ayarla
-    // Eğer buton başlangıçta basılıysa, aiPressed = false yap
-    // Böylece buton bırakıldığında (HIGH) ilk gerçek basışta tetiklenir
-    uint8_t aiStateInit = digitalRead(PIN_AI);
-    aiPressed = false;  // Her zaman false ile başla
-    lastAiReleaseTime = 0;  // Sıfırla
-    
-    subSwPressed = (digitalRead(PIN_SUB_SW) == LOW);
-    
-    // Encoder'ları da oku (başlangıç durumunu kaydetmek için)
-    encMain.readStep();
-    encSub.readStep();
-    return;  // İlk 10 loop'ta sadece durumları oku, event gönderme
+  // Açılış ölçümü: ilk loop ve BLE'nin arka planda hazır olduğu an
+  // (Buton/encoder başlangıç durumları setup()'ta stabil okundu, loop atlanmaz)
+  stallMonitor.loopBegin();
+  stallMonitor.enter(STAGE_DIAG);
+  bootProfile.mark(BOOT_FIRST_LOOP);
+  if (!bootProfile.isMarked(BOOT_BLE_READY) && eventTransport.linkReadyMicros() != 0) {
+    bootProfile.markAt(BOOT_BLE_READY, eventTransport.linkReadyMicros());
   }
 
   // ========================================================================
@@ -309,32 +558,33 @@ void loop() {
   
   // Her encoder'ı oku ve dönüş miktarını al
   // dMain, dSub: -1 (ters yön), 0 (dönüş yok), +1 (ileri yön)
+  stallMonitor.enter(STAGE_ENCODER);
   int8_t dMain  = encMain.readStep();   // Ana menü encoder'ı
   int8_t dSub   = encSub.readStep();    // Alt menü encoder'ı
 
   // Ana Menü Encoder döndü mü?
   if (dMain != 0) {
-    uint32_t now = millis();
-    // Rate limiting: Çok hızlı event gönderimini önle
-    if (now - lastMainRotateTime >= EVENT_RATE_LIMIT_MS) {
-      mainIndex += dMain;  // Pozisyonu güncelle (+1 veya -1)
-      // Ana menü değiştiğinde alt menüyü sıfırla
-      subIndex = 0;  // Alt menü sıfırla
-      // Event gönder: Ana menü değişti
-      sendEvent(MAIN_ROTATE, mainIndex);
-      lastMainRotateTime = now;  // Son event zamanını güncelle
-    }
+    handleMainStep(dMain, true);
   }
 
   // Alt Menü Encoder döndü mü?
   if (dSub != 0) {
-    uint32_t now = millis();
-    // Rate limiting: Çok hızlı event gönderimini önle
-    if (now - lastSubRotateTime >= EVENT_RATE_LIMIT_MS) {
-      subIndex += dSub;  // Pozisyonu güncelle (+1 veya -1)
-      // Event gönder: Alt menü değişti
-      sendEvent(SUB_ROTATE, mainIndex, subIndex);
-      lastSubRotateTime = now;  // Son event zamanını güncelle
+    handleSubStep(dSub, true);
+  }
+
+  // Pozisyon oturdu mu? (son encoder adımından bu yana dwell süresi geçti)
+  stallMonitor.enter(STAGE_SETTLE);
+  if (settlePending) {
+    uint16_t dwellMs = eventTransport.settleDwellMs();
+    uint32_t lastStep = velMain.lastStepTime();
+    if ((int32_t)(velSub.lastStepTime() - lastStep) > 0) {
+      lastStep = velSub.lastStepTime();
+    }
+    if (dwellMs == 0) {
+      settlePending = false;  // SETTLE kapalı
+    } else if (millis() - lastStep >= dwellMs) {
+      settlePending = false;
+      sendEvent(SETTLE, mainIndex, subIndex);
     }
   }
 
@@ -343,6 +593,7 @@ void loop() {
   // ========================================================================
   
   // AI Button (AI Butonu - Sadece Bas-Konuş İçin)
+  stallMonitor.enter(STAGE_BUTTONS);
   uint8_t aiState = digitalRead(PIN_AI);
   
   if (aiState == LOW && !aiPressed) {
@@ -351,16 +602,14 @@ void loop() {
     uint32_t now = millis();
     if (lastAiReleaseTime == 0 || (now - lastAiReleaseTime >= BUTTON_RELEASE_DEBOUNCE_MS)) {
       aiPressed = true;
-      // Event gönder: AI butonu basıldı (bas-konuş başladı)
-      sendEvent(AI_PRESS, mainIndex, subIndex);
+      handleAiPress();
     }
   } else if (aiState == HIGH && aiPressed) {
     // Buton bırakıldı
     aiPressed = false;
     uint32_t now = millis();
     lastAiReleaseTime = now;  // Bırakılma zamanını kaydet (bounce önleme için)
-    // Event gönder: AI butonu bırakıldı (bas-konuş sona erdi)
-    sendEvent(AI_RELEASE, mainIndex, subIndex);
+    handleAiRelease();
   }
 
   // Sub Menu Switch (Alt Menü Encoder'ındaki Basma Butonu)
@@ -371,8 +620,7 @@ void loop() {
     uint32_t now = millis();
     if (now - lastSubSwReleaseTime >= BUTTON_RELEASE_DEBOUNCE_MS) {
       subSwPressed = true;
-      // Event gönder: Alt menü switch'i basıldı (onay işlemi)
-      sendEvent(CONFIRM, mainIndex, subIndex);
+      handleConfirm();
     }
   } else if (subSwState == HIGH && subSwPressed) {
     // Buton bırakıldı
@@ -380,12 +628,25 @@ void loop() {
     uint32_t now = millis();
     lastSubSwReleaseTime = now;  // Bırakılma zamanını kaydet (bounce önleme için)
   }
+
+  // Host'tan enjekte edilen girişler (Serial makine modu; BLE'de her zaman boş)
+  stallMonitor.enter(STAGE_INJECT);
+  InjectedInput injected;
+  for (uint8_t i = 0; i < INJECT_MAX_PER_LOOP && eventTransport.takeInjectedInput(&injected); i++) {
+    applyInjectedInput(injected);
+  }
   
   // Bluetooth durumunu kontrol et ve LED'i yanıp söndür (bağlantı yoksa)
+  stallMonitor.enter(STAGE_ADVERTISING);
   eventTransport.updateAdvertisingStatus();
   #ifdef TRANSPORT_BLE
+  stallMonitor.enter(STAGE_CONNECTION);
   eventTransport.handleConnection();
   #endif
+
+  stallMonitor.enter(STAGE_DIAG);
+  handleDiagnostics();
   
   // Loop burada biter ve tekrar baştan başlar (sürekli döngü)
+  stallMonitor.loopEnd();
 }
@@ -36,4 +36,13 @@
 
   #define PIN_AI        9
   #define PIN_LED       10
+
+  #define PIN_RGB       21   // Kart üstü WS2812 (NeoPixel)
 #endif
+
+// ===============================
+// OPSİYONEL: TİTREŞİM MOTORU
+// ===============================
+// Motor sürücüsü (transistör/MOSFET) bağlıysa tanımlayın.
+// Geri bildirim pattern'leri LED ile birlikte motoru da sürer.
+// #define PIN_VIBRO     11
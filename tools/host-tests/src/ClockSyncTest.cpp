@@ -0,0 +1,190 @@
+/*
+ * ClockSync host testi: simüle edilmiş drift ve jitter altında offset ve
+ * drift tahmininin hata sınırları.
+ *
+ * Model (hepsi µs):
+ * - Telefon saati gerçek zamandır. Cihaz saati = gerçek * (1 + drift) + offset0
+ * - Tek yön radyo gecikmesi = taban + üstel jitter (BLE connection interval)
+ * - Turların bir kısmında sadece tek yöne büyük ek gecikme (asimetrik outlier,
+ *   ör. yeniden iletim) eklenir; offset ölçümünü delay/2 kadar kaydırır
+ * - Ping aralığı app ile aynı: ilk 8 tur 100ms, sonra 1 sn
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <random>
+#include "ClockSync.h"
+#include "TestCheck.h"
+
+struct SimConfig {
+  double driftPpm = 40.0;
+  int64_t offset0Us = 3700000;     // Açılış farkı (cihaz - telefon)
+  double baseDelayUs = 3000.0;     // Tek yön taban gecikme
+  double jitterMeanUs = 7500.0;    // Üstel jitter ortalaması (15ms interval / 2)
+  double outlierRate = 0.10;       // Asimetrik outlier oranı
+  double outlierMinUs = 40000.0;
+  double outlierMaxUs = 200000.0;
+  int64_t durationUs = 600000000;  // 10 dakika
+};
+
+struct SimResult {
+  double maxOffsetErrUs = 0.0;     // Isınmadan sonra en büyük offset hatası
+  double finalDriftErrPpm = 0.0;   // Son drift tahmini hatası
+  uint32_t accepted = 0;
+  uint32_t rejected = 0;
+};
+
+static const int64_t WARMUP_US = 5000000;          // Offset sınırı 5 sn sonra uygulanır
+static const int64_t DRIFT_SETTLE_US = 180000000;  // Drift sınırı 3 dk sonra uygulanır
+
+static SimResult simulate(const SimConfig& cfg, uint64_t seed, double* maxDriftErrAfterSettle) {
+  std::mt19937_64 rng(seed);
+  std::exponential_distribution<double> jitter(1.0 / cfg.jitterMeanUs);
+  std::uniform_real_distribution<double> uni(0.0, 1.0);
+
+  const double rate = 1.0 + cfg.driftPpm * 1e-6;
+  auto deviceAt = [&](double trueUs) { return (int64_t)llround(trueUs * rate) + cfg.offset0Us; };
+  // Cihaz zamanı L iken gerçek offset (cihaz - telefon)
+  auto trueOffsetAt = [&](int64_t localUs) {
+    double trueUs = (double)(localUs - cfg.offset0Us) / rate;
+    return (double)localUs - trueUs;
+  };
+
+  ClockSync sync;
+  SimResult r;
+  *maxDriftErrAfterSettle = 0.0;
+  double t = 1000000.0;  // Gerçek zaman (telefon saati)
+  uint32_t round = 0;
+
+  while (t < cfg.durationUs) {
+    double up = cfg.baseDelayUs + jitter(rng);
+    double down = cfg.baseDelayUs + jitter(rng);
+    if (uni(rng) < cfg.outlierRate) {
+      double extra = cfg.outlierMinUs + uni(rng) * (cfg.outlierMaxUs - cfg.outlierMinUs);
+      if (uni(rng) < 0.5) {
+        up += extra;
+      } else {
+        down += extra;
+      }
+    }
+    double processUs = 200.0 + uni(rng) * 600.0;
+
+    int64_t t1 = (int64_t)llround(t);
+    int64_t t2 = deviceAt(t + up);
+    int64_t t3 = deviceAt(t + up + processUs);
+    int64_t t4 = (int64_t)llround(t + up + processUs + down);
+
+    if (sync.addSample(t1, t2, t3, t4)) {
+      r.accepted++;
+    } else {
+      r.rejected++;
+    }
+
+    // Tahmini bir sonraki ping'e kadar birkaç noktada (event anları) kontrol et
+    double interval = round < 8 ? 100000.0 : 1000000.0;
+    if (sync.isSynced() && t > WARMUP_US) {
+      for (int k = 0; k < 4; k++) {
+        int64_t local = deviceAt(t + interval * k / 4.0);
+        double err = fabs((double)sync.offsetAt(local) - trueOffsetAt(local));
+        if (err > r.maxOffsetErrUs) {
+          r.maxOffsetErrUs = err;
+        }
+      }
+    }
+    if (t > DRIFT_SETTLE_US) {
+      double driftErr = fabs(sync.driftPpm() - cfg.driftPpm);
+      if (driftErr > *maxDriftErrAfterSettle) {
+        *maxDriftErrAfterSettle = driftErr;
+      }
+    }
+    r.finalDriftErrPpm = fabs(sync.driftPpm() - cfg.driftPpm);
+
+    t += interval;
+    round++;
+  }
+  return r;
+}
+
+// Ortak durumlar: ilk örneklerde senkron değil, bozuk turlar reddedilir, reset temizler
+static void testBasics() {
+  ClockSync sync;
+  CHECK(!sync.isSynced());
+  CHECK(sync.addSample(0, 1000500, 1000700, 1200));
+  CHECK(sync.addSample(100000, 1100500, 1100700, 101200));
+  CHECK(!sync.isSynced());  // MIN_SAMPLES = 3
+  CHECK(sync.addSample(200000, 1200500, 1200700, 201200));
+  CHECK(sync.isSynced());
+  // Simetrik 500µs gecikme, cihaz 1 sn önde: offset tam 1 sn çıkmalı
+  CHECK_MSG(llabs(sync.offsetAt(1200600) - 1000000) <= 1, "offset=%lld",
+            (long long)sync.offsetAt(1200600));
+  CHECK(sync.bestDelay() == 1000);
+
+  CHECK(!sync.addSample(0, 100, 50, 10));                         // t3 < t2
+  CHECK(!sync.addSample(0, 100, 200, 50));                        // Negatif delay
+  CHECK(!sync.addSample(0, 100, 200, ClockSync::MAX_DELAY_US + 200));  // Çok gecikmiş
+  CHECK(sync.sampleCount() == 3);
+
+  sync.reset();
+  CHECK(!sync.isSynced());
+  CHECK(sync.sampleCount() == 0);
+  CHECK(sync.driftPpm() == 0.0);
+}
+
+// Offset ve drift hata sınırları (birkaç seed, pozitif / negatif drift)
+static void testDriftAndJitter() {
+  static const double OFFSET_ERR_MAX_US = 2500.0;  // Konuşma gecikmesine göre önemsiz
+  static const double DRIFT_ERR_MAX_PPM = 10.0;   // 3 dk sonra; 10 dk'da 6ms'den az kayma
+
+  const double drifts[] = { 40.0, -40.0, 0.0 };
+  for (double drift : drifts) {
+    for (uint64_t seed = 1; seed <= 8; seed++) {
+      SimConfig cfg;
+      cfg.driftPpm = drift;
+      double maxDriftErr = 0.0;
+      SimResult r = simulate(cfg, seed * 7919 + (uint64_t)(drift + 100), &maxDriftErr);
+      int failuresBefore = testFailures;
+      CHECK_MSG(r.maxOffsetErrUs < OFFSET_ERR_MAX_US, "drift=%.0f seed=%llu err=%.0fus", drift,
+                (unsigned long long)seed, r.maxOffsetErrUs);
+      CHECK_MSG(maxDriftErr < DRIFT_ERR_MAX_PPM, "drift=%.0f seed=%llu err=%.2fppm", drift,
+                (unsigned long long)seed, maxDriftErr);
+      CHECK(r.accepted > 500);
+      // Ayrıntı sadece hata varsa (ctest çıktısını kirletmesin)
+      if (testFailures != failuresBefore) {
+        printf("  drift=%+.0fppm seed=%llu offset_err_max=%.0fus drift_err_max=%.2fppm final=%.2fppm "
+               "accepted=%u rejected=%u\n",
+               drift, (unsigned long long)seed, r.maxOffsetErrUs, maxDriftErr, r.finalDriftErrPpm,
+               r.accepted, r.rejected);
+      }
+    }
+  }
+}
+
+// Drift düzeltmesi olmadan 40ppm, 10 dakikada 24ms kayma demektir; tahmin
+// son örnekten 30 sn sonra (ping'ler kesilmiş) bile bunun çok altında kalmalı
+static void testExtrapolation() {
+  SimConfig cfg;
+  std::mt19937_64 rng(42);
+  std::exponential_distribution<double> jitter(1.0 / cfg.jitterMeanUs);
+  const double rate = 1.0 + cfg.driftPpm * 1e-6;
+  ClockSync sync;
+  double t = 0.0;
+  for (int i = 0; i < 600; i++) {
+    double up = cfg.baseDelayUs + jitter(rng);
+    double down = cfg.baseDelayUs + jitter(rng);
+    int64_t t2 = (int64_t)llround((t + up) * rate) + cfg.offset0Us;
+    sync.addSample((int64_t)t, t2, t2 + 300, (int64_t)llround(t + up + 300 / rate + down));
+    t += 1000000.0;
+  }
+  double later = t + 30000000.0;
+  int64_t local = (int64_t)llround(later * rate) + cfg.offset0Us;
+  double trueOffset = (double)local - later;
+  double err = fabs((double)sync.offsetAt(local) - trueOffset);
+  CHECK_MSG(err < 2000.0, "30 sn sonra offset hatası %.0fus", err);
+}
+
+int main() {
+  testBasics();
+  testDriftAndJitter();
+  testExtrapolation();
+  return TEST_RESULT("ClockSync");
+}
@@ -0,0 +1,390 @@
+/*
+ * OtaDecoder host testi: heatshrink açma ve delta yama zincirinin
+ * BLE'deki gibi parça parça (1 byte ve MTU boyutunda) beslenmesi,
+ * kesik / bozuk giriş ve LimitSink taşma kontrolü.
+ *
+ * Heatshrink verisi aşağıdaki referans kodlayıcıyla üretilir (açgözlü
+ * LZSS, OtaDecoder.h'deki bit formatı ile aynı).
+ */
+
+#include <stdint.h>
+#include <random>
+#include <vector>
+#include "OtaDecoder.h"
+#include "TestCheck.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static const size_t MTU_CHUNK = 244;  // 247 MTU - 3 byte ATT başlığı
+
+/* ---------------------------------------------------------
+   Test yardımcıları
+   --------------------------------------------------------- */
+
+struct VectorSink : public OtaSink {
+  Bytes data;
+  size_t failAfter = SIZE_MAX;  // Bu kadar byte'tan sonra yazma hatası
+  bool write(const uint8_t* d, size_t len) override {
+    if (data.size() + len > failAfter) {
+      return false;
+    }
+    data.insert(data.end(), d, d + len);
+    return true;
+  }
+};
+
+struct VectorBase : public OtaBaseReader {
+  const Bytes* image = nullptr;
+  bool read(uint32_t offset, uint8_t* d, size_t len) override {
+    if (offset + len > image->size()) {
+      return false;
+    }
+    memcpy(d, image->data() + offset, len);
+    return true;
+  }
+  uint32_t size() const override { return (uint32_t)image->size(); }
+};
+
+// Firmware'e benzer veri: tekrar eden bloklar, sabit tablolar ve rastgele kod
+static Bytes makeImage(size_t size, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  Bytes out;
+  while (out.size() < size) {
+    switch (rng() % 3) {
+      case 0: {  // Rastgele "kod"
+        size_t n = 16 + rng() % 64;
+        for (size_t i = 0; i < n; i++) out.push_back((uint8_t)rng());
+        break;
+      }
+      case 1: {  // Sıfır / 0xFF dolgu
+        size_t n = 8 + rng() % 48;
+        out.insert(out.end(), n, (rng() & 1) ? 0x00 : 0xFF);
+        break;
+      }
+      default: {  // Önceki bir bölümün tekrarı
+        if (out.size() < 64) break;
+        size_t from = out.size() - 1 - rng() % (out.size() < 900 ? out.size() : 900);
+        size_t n = 4 + rng() % 40;
+        for (size_t i = 0; i < n; i++) out.push_back(out[from + i]);
+        break;
+      }
+    }
+  }
+  out.resize(size);
+  return out;
+}
+
+class BitWriter {
+public:
+  void put(uint32_t value, uint8_t bits) {
+    for (int b = bits - 1; b >= 0; b--) {
+      _cur = (uint8_t)((_cur << 1) | ((value >> b) & 1));
+      if (++_n == 8) {
+        out.push_back(_cur);
+        _cur = 0;
+        _n = 0;
+      }
+    }
+  }
+  // Son bayt sıfır bitlerle doldurulur (tam token oluşturamaz)
+  Bytes finish() {
+    if (_n > 0) {
+      out.push_back((uint8_t)(_cur << (8 - _n)));
+    }
+    return out;
+  }
+  Bytes out;
+
+private:
+  uint8_t _cur = 0;
+  uint8_t _n = 0;
+};
+
+// Referans heatshrink kodlayıcı (açgözlü en uzun eşleşme)
+static Bytes heatshrinkEncode(const Bytes& in, uint8_t w, uint8_t l) {
+  const size_t maxOffset = (size_t)1 << w;
+  const size_t maxLen = (size_t)1 << l;
+  BitWriter bw;
+  size_t i = 0;
+  while (i < in.size()) {
+    size_t bestLen = 0;
+    size_t bestOffset = 0;
+    size_t limit = in.size() - i < maxLen ? in.size() - i : maxLen;
+    for (size_t off = 1; off <= maxOffset && off <= i; off++) {
+      size_t n = 0;
+      while (n < limit && in[i + n] == in[i - off + n]) n++;  // Örtüşen kopya serbest
+      if (n > bestLen) {
+        bestLen = n;
+        bestOffset = off;
+        if (n == limit) break;
+      }
+    }
+    if (bestLen >= 2) {
+      bw.put(0, 1);
+      bw.put((uint32_t)(bestOffset - 1), w);
+      bw.put((uint32_t)(bestLen - 1), l);
+      i += bestLen;
+    } else {
+      bw.put(1, 1);
+      bw.put(in[i], 8);
+      i++;
+    }
+  }
+  return bw.finish();
+}
+
+static void putU32(Bytes& out, uint32_t v) {
+  for (int i = 0; i < 4; i++) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void deltaCopy(Bytes& patch, uint32_t offset, uint32_t len) {
+  patch.push_back(0x01);
+  putU32(patch, offset);
+  putU32(patch, len);
+}
+
+static void deltaInsert(Bytes& patch, const uint8_t* data, uint32_t len) {
+  patch.push_back(0x02);
+  putU32(patch, len);
+  patch.insert(patch.end(), data, data + len);
+}
+
+// Yeni görüntü = base'in kaydırılmış parçaları + araya eklenmiş yeni kod
+struct DeltaCase {
+  Bytes base;
+  Bytes image;
+  Bytes patch;
+};
+
+static DeltaCase makeDelta(uint64_t seed) {
+  DeltaCase c;
+  c.base = makeImage(24000, seed);
+  Bytes fresh = makeImage(6000, seed + 1);
+  std::mt19937_64 rng(seed + 2);
+  size_t freshPos = 0;
+  uint32_t basePos = 0;
+  while (basePos < c.base.size()) {
+    uint32_t n = 500 + rng() % 3000;
+    if (basePos + n > c.base.size()) n = (uint32_t)(c.base.size() - basePos);
+    deltaCopy(c.patch, basePos, n);
+    c.image.insert(c.image.end(), c.base.begin() + basePos, c.base.begin() + basePos + n);
+    basePos += n + rng() % 200;  // Base'in bir kısmı atlanır (silinen kod)
+
+    uint32_t k = (uint32_t)(rng() % 400);
+    if (freshPos + k > fresh.size()) k = (uint32_t)(fresh.size() - freshPos);
+    deltaInsert(c.patch, fresh.data() + freshPos, k);  // k = 0 da geçerli
+    c.image.insert(c.image.end(), fresh.begin() + freshPos, fresh.begin() + freshPos + k);
+    freshPos += k;
+  }
+  return c;
+}
+
+// Akışı chunk byte'lık parçalarla besle; hata kodunu döndür
+static OtaDecodeError run(const Bytes& stream, size_t chunk, OtaEncoding enc, bool delta,
+                          uint8_t w, uint8_t l, uint32_t outSize, const Bytes* base,
+                          VectorSink& sink) {
+  static OtaDecoder decoder;  // 4KB pencere: stack yerine statik
+  VectorBase reader;
+  reader.image = base;
+  if (!decoder.begin(enc, delta, w, l, outSize, base != nullptr ? &reader : nullptr, &sink)) {
+    return decoder.error();
+  }
+  for (size_t i = 0; i < stream.size(); i += chunk) {
+    size_t n = stream.size() - i < chunk ? stream.size() - i : chunk;
+    if (!decoder.feed(stream.data() + i, n)) {
+      return decoder.error();
+    }
+  }
+  CHECK(decoder.consumed() == stream.size());
+  if (!decoder.finish()) {
+    return decoder.error();
+  }
+  return OTA_OK;
+}
+
+/* ---------------------------------------------------------
+   Testler
+   --------------------------------------------------------- */
+
+static const size_t CHUNKS[] = { 1, MTU_CHUNK, 100000 };
+
+// Sıkıştırmasız ve heatshrink görüntü, farklı W/L ve parça boyutları
+static void testHeatshrinkRoundTrip() {
+  Bytes image = makeImage(20000, 11);
+  const uint8_t params[][2] = { {10, 4}, {8, 4}, {12, 5}, {4, 3} };
+  for (const auto& p : params) {
+    Bytes packed = heatshrinkEncode(image, p[0], p[1]);
+    if (p[0] >= 8) {
+      CHECK_MSG(packed.size() < image.size(), "w=%u l=%u sıkıştırmadı", p[0], p[1]);
+    }
+    for (size_t chunk : CHUNKS) {
+      VectorSink sink;
+      OtaDecodeError err = run(packed, chunk, OTA_ENC_HEATSHRINK, false, p[0], p[1],
+                               (uint32_t)image.size(), nullptr, sink);
+      CHECK_MSG(err == OTA_OK, "w=%u l=%u chunk=%zu err=%u", p[0], p[1], chunk, err);
+      CHECK_MSG(sink.data == image, "w=%u l=%u chunk=%zu çıkış farklı", p[0], p[1], chunk);
+    }
+  }
+
+  for (size_t chunk : CHUNKS) {
+    VectorSink sink;
+    CHECK(run(image, chunk, OTA_ENC_RAW, false, 0, 0, (uint32_t)image.size(), nullptr, sink) == OTA_OK);
+    CHECK(sink.data == image);
+  }
+}
+
+// Delta yama, sıkıştırmasız ve heatshrink ile
+static void testDeltaRoundTrip() {
+  DeltaCase c = makeDelta(21);
+  Bytes packed = heatshrinkEncode(c.patch, 10, 4);
+  for (size_t chunk : CHUNKS) {
+    VectorSink raw;
+    OtaDecodeError err = run(c.patch, chunk, OTA_ENC_RAW, true, 0, 0, (uint32_t)c.image.size(),
+                             &c.base, raw);
+    CHECK_MSG(err == OTA_OK, "raw delta chunk=%zu err=%u", chunk, err);
+    CHECK(raw.data == c.image);
+
+    VectorSink hs;
+    err = run(packed, chunk, OTA_ENC_HEATSHRINK, true, 10, 4, (uint32_t)c.image.size(), &c.base, hs);
+    CHECK_MSG(err == OTA_OK, "heatshrink delta chunk=%zu err=%u", chunk, err);
+    CHECK(hs.data == c.image);
+  }
+}
+
+// Kesik giriş: finish() eksik çıkışı veya yarım delta işlemini yakalamalı
+static void testTruncated() {
+  Bytes image = makeImage(8000, 31);
+  Bytes packed = heatshrinkEncode(image, 10, 4);
+  Bytes cut(packed.begin(), packed.end() - 40);
+  for (size_t chunk : CHUNKS) {
+    VectorSink sink;
+    OtaDecodeError err = run(cut, chunk, OTA_ENC_HEATSHRINK, false, 10, 4, (uint32_t)image.size(),
+                             nullptr, sink);
+    CHECK_MSG(err == OTA_ERR_TRUNCATED, "chunk=%zu err=%u", chunk, err);
+  }
+
+  DeltaCase c = makeDelta(32);
+  // Son INSERT'in veri kısmının ortasında kes
+  Bytes midOp(c.patch.begin(), c.patch.end() - 3);
+  // İşlem sınırında kes: son INSERT tamamen yok (op + len + veri)
+  size_t lastInsert = c.patch.size();
+  for (size_t i = 0; i + 5 <= c.patch.size(); i++) {
+    if (c.patch[i] == 0x02) {
+      uint32_t len = c.patch[i + 1] | (c.patch[i + 2] << 8) | (c.patch[i + 3] << 16) | ((uint32_t)c.patch[i + 4] << 24);
+      if (i + 5 + len == c.patch.size()) {
+        lastInsert = i;
+        break;
+      }
+    }
+  }
+  CHECK(lastInsert < c.patch.size());
+  Bytes atOp(c.patch.begin(), c.patch.begin() + lastInsert);
+  for (size_t chunk : CHUNKS) {
+    VectorSink a;
+    CHECK(run(midOp, chunk, OTA_ENC_RAW, true, 0, 0, (uint32_t)c.image.size(), &c.base, a) ==
+          OTA_ERR_DELTA);
+    VectorSink b;
+    OtaDecodeError err = run(atOp, chunk, OTA_ENC_RAW, true, 0, 0, (uint32_t)c.image.size(), &c.base, b);
+    // Son INSERT boşsa çıkış zaten tamdır
+    CHECK(err == OTA_ERR_TRUNCATED || (err == OTA_OK && b.data == c.image));
+  }
+}
+
+// Bozuk giriş: hata kodu ya da en azından farklı çıkış (SHA-256 yakalar); asla taşma yok
+static void testCorrupt() {
+  DeltaCase c = makeDelta(41);
+  const uint32_t outSize = (uint32_t)c.image.size();
+
+  Bytes badOp = c.patch;
+  badOp[0] = 0x7F;
+  VectorSink s1;
+  CHECK(run(badOp, MTU_CHUNK, OTA_ENC_RAW, true, 0, 0, outSize, &c.base, s1) == OTA_ERR_DELTA);
+  CHECK(s1.data.empty());
+
+  Bytes badCopy;
+  deltaCopy(badCopy, (uint32_t)c.base.size() - 10, 20);  // Base sınırını aşar
+  VectorSink s2;
+  CHECK(run(badCopy, 1, OTA_ENC_RAW, true, 0, 0, outSize, &c.base, s2) == OTA_ERR_BASE);
+
+  Bytes hugeCopy;
+  deltaCopy(hugeCopy, 0xFFFFFFF0u, 0x20);  // offset + len taşması
+  VectorSink s3;
+  CHECK(run(hugeCopy, 1, OTA_ENC_RAW, true, 0, 0, outSize, &c.base, s3) == OTA_ERR_BASE);
+
+  // Sıkıştırılmış akışta rastgele byte bozulmaları
+  Bytes image = makeImage(8000, 42);
+  Bytes packed = heatshrinkEncode(image, 10, 4);
+  // (aynı byte'ları kopyalayan bir index bozulması zararsızdır, bu yüzden oran kontrol edilir)
+  std::mt19937_64 rng(43);
+  int detected = 0;
+  for (int trial = 0; trial < 50; trial++) {
+    Bytes bad = packed;
+    for (int k = 0; k < 3; k++) {
+      bad[rng() % (bad.size() - 1)] ^= (uint8_t)(1 + rng() % 255);
+    }
+    VectorSink sink;
+    OtaDecodeError err = run(bad, MTU_CHUNK, OTA_ENC_HEATSHRINK, false, 10, 4, (uint32_t)image.size(),
+                             nullptr, sink);
+    CHECK(sink.data.size() <= image.size());
+    CHECK(err != OTA_OK || sink.data.size() == image.size());
+    if (err != OTA_OK || sink.data != image) {
+      detected++;
+    }
+  }
+  CHECK_MSG(detected >= 45, "sadece %d/50 bozulma fark edildi", detected);
+}
+
+// LimitSink: outSize'ı aşan çıkış sink'e hiç yazılmamalı
+static void testOverflow() {
+  Bytes image = makeImage(5000, 51);
+  const uint32_t small = 4096;
+  for (size_t chunk : CHUNKS) {
+    VectorSink raw;
+    CHECK(run(image, chunk, OTA_ENC_RAW, false, 0, 0, small, nullptr, raw) == OTA_ERR_OVERFLOW);
+    CHECK(raw.data.size() <= small);
+
+    Bytes packed = heatshrinkEncode(image, 10, 4);
+    VectorSink hs;
+    CHECK(run(packed, chunk, OTA_ENC_HEATSHRINK, false, 10, 4, small, nullptr, hs) == OTA_ERR_OVERFLOW);
+    CHECK(hs.data.size() <= small);
+    CHECK(Bytes(image.begin(), image.begin() + hs.data.size()) == hs.data);
+  }
+
+  // Delta COPY'si LimitSink üzerinden taşar: hata SINK değil OVERFLOW olmalı
+  DeltaCase c = makeDelta(52);
+  for (size_t chunk : CHUNKS) {
+    VectorSink sink;
+    OtaDecodeError err = run(c.patch, chunk, OTA_ENC_RAW, true, 0, 0, (uint32_t)c.image.size() - 1,
+                             &c.base, sink);
+    CHECK_MSG(err == OTA_ERR_OVERFLOW, "chunk=%zu err=%u", chunk, err);
+    CHECK(sink.data.size() < c.image.size());
+  }
+}
+
+// Parametre ve sink hataları
+static void testErrors() {
+  VectorSink sink;
+  Bytes base(16, 0);
+  CHECK(run(Bytes(), 1, OTA_ENC_HEATSHRINK, false, 13, 4, 10, nullptr, sink) == OTA_ERR_PARAMS);
+  CHECK(run(Bytes(), 1, OTA_ENC_HEATSHRINK, false, 8, 8, 10, nullptr, sink) == OTA_ERR_PARAMS);
+  CHECK(run(Bytes(), 1, OTA_ENC_HEATSHRINK, false, 8, 2, 10, nullptr, sink) == OTA_ERR_PARAMS);
+  CHECK(run(Bytes(), 1, (OtaEncoding)7, false, 0, 0, 10, nullptr, sink) == OTA_ERR_PARAMS);
+  CHECK(run(Bytes(), 1, OTA_ENC_RAW, true, 0, 0, 10, nullptr, sink) == OTA_ERR_PARAMS);
+  CHECK(run(Bytes(), 1, OTA_ENC_RAW, false, 0, 0, 0, nullptr, sink) == OTA_ERR_PARAMS);
+
+  Bytes image = makeImage(3000, 61);
+  VectorSink failing;
+  failing.failAfter = 1000;
+  CHECK(run(image, MTU_CHUNK, OTA_ENC_RAW, false, 0, 0, (uint32_t)image.size(), nullptr, failing) ==
+        OTA_ERR_SINK);
+}
+
+int main() {
+  testHeatshrinkRoundTrip();
+  testDeltaRoundTrip();
+  testTruncated();
+  testCorrupt();
+  testOverflow();
+  testErrors();
+  return TEST_RESULT("OtaDecoder");
+}
@@ -0,0 +1,244 @@
+/*
+ * SerialFrame host testi: COBS ve frame kur / çöz döngüsü (0x00 yoğun
+ * payload'lar, 254 / 255 byte'lık sıfırsız bloklar), bozuk CRC'nin
+ * reddi, frame'ler arasına karışan [BOOT] metninden sonra toparlanma
+ * ve FRAME_MAX_ENCODED taşmasının errors()'a yazılması.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <random>
+#include <vector>
+#include "SerialFrame.h"
+#include "TestCheck.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+/* ---------------------------------------------------------
+   Test yardımcıları
+   --------------------------------------------------------- */
+
+// Kenar durumları: boş, hep sıfır, COBS blok sınırları, karışık
+static std::vector<Bytes> makePayloads() {
+  std::vector<Bytes> out;
+  out.push_back(Bytes());
+  out.push_back(Bytes(1, 0x00));
+  out.push_back(Bytes(2, 0x00));
+  out.push_back(Bytes(300, 0x00));
+  for (size_t run : { (size_t)253, (size_t)254, (size_t)255, (size_t)256, (size_t)508 }) {
+    out.push_back(Bytes(run, 0xA5));
+    Bytes zeroEnd(run, 0x5A);  // Blok sınırında sıfır
+    zeroEnd.push_back(0x00);
+    out.push_back(zeroEnd);
+    Bytes zeroStart(1, 0x00);
+    zeroStart.insert(zeroStart.end(), run, 0x5A);
+    out.push_back(zeroStart);
+  }
+  Bytes alternating;
+  for (size_t i = 0; i < FRAME_MAX_PAYLOAD; i++) {
+    alternating.push_back((i & 1) ? 0x00 : (uint8_t)i | 1);
+  }
+  out.push_back(alternating);
+  out.push_back(Bytes(FRAME_MAX_PAYLOAD, 0x00));
+  out.push_back(Bytes(FRAME_MAX_PAYLOAD, 0xFF));
+
+  std::mt19937 rng(7);
+  for (int i = 0; i < 50; i++) {
+    Bytes p(rng() % (FRAME_MAX_PAYLOAD + 1));
+    for (uint8_t& b : p) {
+      b = (rng() % 4 == 0) ? 0x00 : (uint8_t)rng();  // ~%25 sıfır
+    }
+    out.push_back(p);
+  }
+  return out;
+}
+
+static Bytes buildFrame(uint8_t type, uint8_t seq, const Bytes& payload) {
+  Bytes out(FRAME_MAX_ENCODED + 2);
+  size_t n = SerialFrame::build(type, seq, payload.data(), payload.size(), out.data());
+  out.resize(n);
+  return out;
+}
+
+// Ham frame'i (CRC dahil) verildiği gibi kodla; bozuk CRC üretmek için
+static Bytes encodeRaw(const Bytes& raw) {
+  Bytes out(raw.size() + raw.size() / 254 + 3);
+  out[0] = 0;
+  size_t n = SerialFrame::cobsEncode(raw.data(), raw.size(), out.data() + 1);
+  out[n + 1] = 0;
+  out.resize(n + 2);
+  return out;
+}
+
+// Akışı byte byte besle, tamamlanan frame sayısını döndür
+static int feed(FrameReader& reader, const Bytes& stream) {
+  int frames = 0;
+  for (uint8_t b : stream) {
+    if (reader.push(b)) {
+      frames++;
+    }
+  }
+  return frames;
+}
+
+static bool samePayload(const FrameReader& reader, const Bytes& payload) {
+  return reader.payloadLen() == payload.size() &&
+         (payload.empty() || memcmp(reader.payload(), payload.data(), payload.size()) == 0);
+}
+
+/* ---------------------------------------------------------
+   Testler
+   --------------------------------------------------------- */
+
+// COBS: çıktıda 0x00 yok, boyut sınırı tutuyor, çözünce aynı
+static void testCobsRoundTrip() {
+  for (const Bytes& p : makePayloads()) {
+    Bytes enc(p.size() + p.size() / 254 + 1);
+    size_t n = SerialFrame::cobsEncode(p.data(), p.size(), enc.data());
+    CHECK_MSG(n <= enc.size(), "len=%zu enc=%zu", p.size(), n);
+    CHECK_MSG(memchr(enc.data(), 0, n) == nullptr, "len=%zu", p.size());
+
+    Bytes dec(p.size() + 1);
+    size_t m = SerialFrame::cobsDecode(enc.data(), n, dec.data(), dec.size());
+    CHECK_MSG(m == p.size() && memcmp(dec.data(), p.data(), m) == 0, "len=%zu dec=%zu", p.size(), m);
+  }
+}
+
+// Frame kur, tek akışta art arda oku: her frame son byte'ında tamamlanır
+static void testFrameRoundTrip() {
+  std::vector<Bytes> payloads = makePayloads();
+  FrameReader reader;
+  uint8_t seq = 0;
+  for (const Bytes& p : payloads) {
+    Bytes frame = buildFrame(FRAME_TEXT, seq, p);
+    CHECK_MSG(!frame.empty() && frame.size() <= FRAME_MAX_ENCODED + 2, "len=%zu frame=%zu", p.size(),
+              frame.size());
+
+    int frames = 0;
+    for (size_t i = 0; i < frame.size(); i++) {
+      if (reader.push(frame[i])) {
+        frames++;
+        CHECK_MSG(i == frame.size() - 1, "len=%zu erken frame i=%zu", p.size(), i);
+      }
+    }
+    CHECK_MSG(frames == 1, "len=%zu frames=%d", p.size(), frames);
+    CHECK(reader.type() == FRAME_TEXT);
+    CHECK(reader.seq() == seq);
+    CHECK_MSG(samePayload(reader, p), "len=%zu got=%zu", p.size(), reader.payloadLen());
+    seq++;
+  }
+  CHECK(reader.errors() == 0);
+
+  // Payload sınırı
+  Bytes tooLong(FRAME_MAX_PAYLOAD + 1, 0x11);
+  uint8_t out[FRAME_MAX_ENCODED + 2];
+  CHECK(SerialFrame::build(FRAME_TEXT, 0, tooLong.data(), tooLong.size(), out) == 0);
+
+  // Alan yardımcıları
+  uint8_t buf[4];
+  SerialFrame::putU16(buf, 0xBEEF);
+  CHECK(buf[0] == 0xEF && buf[1] == 0xBE && SerialFrame::getU16(buf) == 0xBEEF);
+  SerialFrame::putU32(buf, 0x12345678);
+  CHECK(buf[0] == 0x78 && buf[3] == 0x12 && SerialFrame::getU32(buf) == 0x12345678);
+}
+
+// Bozuk CRC veya veri: frame verilmez, errors() artar, sonraki frame okunur
+static void testBadCrc() {
+  Bytes payload = { 0x00, 0x01, 0x00, 0x00, 0x02, 0xFF };
+  Bytes raw = { FRAME_EVENT, 9 };
+  raw.insert(raw.end(), payload.begin(), payload.end());
+  uint16_t crc = SerialFrame::crc16(raw.data(), raw.size());
+  raw.push_back(0);
+  raw.push_back(0);
+
+  FrameReader reader;
+  Bytes good = raw;
+  SerialFrame::putU16(good.data() + good.size() - 2, crc);
+  CHECK(feed(reader, encodeRaw(good)) == 1);
+  CHECK(samePayload(reader, payload));
+
+  for (uint16_t flip : { (uint16_t)0x0001, (uint16_t)0x8000, (uint16_t)0x00FF }) {
+    Bytes bad = raw;
+    SerialFrame::putU16(bad.data() + bad.size() - 2, (uint16_t)(crc ^ flip));
+    uint32_t before = reader.errors();
+    CHECK_MSG(feed(reader, encodeRaw(bad)) == 0, "flip=%04x", flip);
+    CHECK_MSG(reader.errors() == before + 1, "flip=%04x errors=%u", flip, (unsigned)reader.errors());
+  }
+
+  // CRC doğru, payload'da tek bit değişmiş
+  Bytes frame = buildFrame(FRAME_EVENT, 9, payload);
+  for (size_t i = 1; i + 1 < frame.size(); i++) {
+    Bytes bad = frame;
+    bad[i] ^= (bad[i] == 0x01) ? 0x02 : 0x01;  // 0x00 (ayraç) üretme
+    uint32_t before = reader.errors();
+    CHECK_MSG(feed(reader, bad) == 0, "i=%zu", i);
+    CHECK_MSG(reader.errors() > before, "i=%zu", i);
+  }
+
+  uint32_t before = reader.errors();
+  CHECK(feed(reader, frame) == 1);
+  CHECK(reader.errors() == before);
+  CHECK(reader.seq() == 9 && samePayload(reader, payload));
+}
+
+// Açılıştaki ve frame'ler arasındaki [BOOT] satırı frame'leri bozmaz
+static void testTextRecovery() {
+  const char* bootLine = "[BOOT] reset=POWERON heap=312456\r\n";
+  Bytes text(bootLine, bootLine + strlen(bootLine));
+  Bytes p1 = { 0x10, 0x00, 0x20 };
+  Bytes p2 = { 0x00, 0x00, 0x30, 0x00 };
+
+  FrameReader reader;
+  CHECK(feed(reader, text) == 0);
+  CHECK(!reader.synced() && reader.pending() == 0);  // Senkron öncesi metin alınmaz
+  CHECK(reader.errors() == 0);
+
+  CHECK(feed(reader, buildFrame(FRAME_EVENT, 1, p1)) == 1);
+  CHECK(reader.seq() == 1 && samePayload(reader, p1));
+
+  // Frame'den sonra senkron: metin bir "frame" olarak birikir, sonraki ayraçta reddedilir
+  CHECK(feed(reader, text) == 0);
+  CHECK(reader.pending() == text.size());
+  CHECK(feed(reader, buildFrame(FRAME_EVENT, 2, p2)) == 1);
+  CHECK(reader.errors() == 1);
+  CHECK(reader.seq() == 2 && samePayload(reader, p2));
+
+  // unsync sonrası metin yine yok sayılır
+  reader.unsync();
+  CHECK(feed(reader, text) == 0);
+  CHECK(reader.pending() == 0 && reader.errors() == 1);
+  CHECK(feed(reader, buildFrame(FRAME_EVENT, 3, p1)) == 1);
+  CHECK(reader.seq() == 3);
+}
+
+// Ayraçsız FRAME_MAX_ENCODED'dan uzun veri: errors() artar, senkron düşer
+static void testOverflow() {
+  FrameReader reader;
+  CHECK(!reader.push(0x00));
+  Bytes junk(FRAME_MAX_ENCODED, 0x41);
+  CHECK(feed(reader, junk) == 0);
+  CHECK(reader.synced() && reader.pending() == FRAME_MAX_ENCODED);
+  CHECK(reader.errors() == 0);
+
+  CHECK(!reader.push(0x41));
+  CHECK(reader.errors() == 1);
+  CHECK(!reader.synced() && reader.pending() == 0);
+
+  // Sonraki 0x00'a kadar atılır, tek hata sayılır
+  CHECK(feed(reader, junk) == 0);
+  CHECK(reader.errors() == 1);
+
+  Bytes payload(FRAME_MAX_PAYLOAD, 0x7E);  // En uzun frame taşma sayılmaz
+  CHECK(feed(reader, buildFrame(FRAME_TEXT, 4, payload)) == 1);
+  CHECK(reader.errors() == 1);
+  CHECK(samePayload(reader, payload));
+}
+
+int main() {
+  testCobsRoundTrip();
+  testFrameRoundTrip();
+  testBadCrc();
+  testTextRecovery();
+  testOverflow();
+  return TEST_RESULT("SerialFrame");
+}
@@ -0,0 +1,33 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <stdio.h>
+
+/* Host testleri için küçük doğrulama makroları. Başarısız CHECK satırı
+   basar ve sayacı artırır; test main()'i TEST_RESULT() ile biter. */
+
+static int testFailures = 0;
+
+#define CHECK(cond)                                                       \
+  do {                                                                    \
+    if (!(cond)) {                                                        \
+      fprintf(stderr, "[FAIL] %s:%d: %s\n", __FILE__, __LINE__, #cond);   \
+      testFailures++;                                                     \
+    }                                                                     \
+  } while (0)
+
+#define CHECK_MSG(cond, ...)                                              \
+  do {                                                                    \
+    if (!(cond)) {                                                        \
+      fprintf(stderr, "[FAIL] %s:%d: %s: ", __FILE__, __LINE__, #cond);   \
+      fprintf(stderr, __VA_ARGS__);                                       \
+      fprintf(stderr, "\n");                                              \
+      testFailures++;                                                     \
+    }                                                                     \
+  } while (0)
+
+#define TEST_RESULT(name)                                                 \
+  (printf("[TEST] %s %s\n", name, testFailures == 0 ? "PASS" : "FAIL"),   \
+   testFailures == 0 ? 0 : 1)
+
+#endif // TEST_CHECK_H
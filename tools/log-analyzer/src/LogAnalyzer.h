@@ -0,0 +1,691 @@
+#ifndef LOG_ANALYZER_H
+#define LOG_ANALYZER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "LogParser.h"
+
+/* =========================================================
+   LOG ANALYZER (Event Dizisi ve Zamanlama Analizi)
+   =========================================================
+
+   LogRecord akışını tek geçişte işler:
+   - Event dizisini yeniden kurar ([DEBUG] ve [BLE] satırları aynı
+     event'i anlatıyorsa birleştirilir, seq alınır)
+   - Event türü başına ardışık event aralığı dağılımı
+   - Rotate hız ipucu ("v") dağılımı ve son rotate -> SETTLE süresi
+   - Rate limit: aynı encoder'da limitin hemen üstündeki aralıklar
+     (kullanıcı limitten hızlı çeviriyor, adımlar atlanıyor) ve
+     limitin altındaki aralıklar (olmamalı)
+   - Index/seq atlamaları: kayıtta eksik event (kayıp satır/paket)
+   - Blocking: host zaman damgası varsa, host'ta geçen süre ile
+     cihaz ts farkı arasındaki gecikme (Serial/loop bloklanması)
+     ve sendEvent süresi
+   - Pairing/bağlantı zaman çizelgesi ve oturum (reboot) ayrımı
+   - [STALL] satırları: bütçeyi aşan loop turları (aşama bazında)
+     ve watchdog'un yakaladığı takılmalar
+
+   Cihaz zamanı satır bazında yoktur; event olmayan satırlar
+   oturumdaki son bilinen cihaz zamanına (event ts / [BOOT] t)
+   bağlanır, bu yüzden timeline'da "~" ile gösterilir.
+*/
+
+struct AnalyzerConfig {
+  uint32_t rateLimitMs = 100;   // Firmware EVENT_RATE_LIMIT_MS
+  uint32_t nearLimitMs = 50;    // [limit, limit + near) aralığı "limitte" sayılır
+  uint32_t gapMs = 50;          // Bu kadar host gecikmesi blocking sayılır
+  bool printTimeline = false;
+  bool printEvents = false;
+  size_t topGaps = 10;
+};
+
+// Dağılım (percentile için değerler saklanır; saatlik kayıtta bile birkaç yüz bin)
+class Distribution {
+public:
+  void add(uint32_t v) { _values.push_back(v); }
+  size_t count() const { return _values.size(); }
+
+  // histogram: ms aralık kovaları (ms olmayan değerler için false)
+  void print(FILE* out, const char* label, bool histogram = true) {
+    if (_values.empty()) {
+      fprintf(out, "  %-14s count=0\n", label);
+      return;
+    }
+    std::sort(_values.begin(), _values.end());
+    uint64_t sum = 0;
+    for (uint32_t v : _values) {
+      sum += v;
+    }
+    fprintf(out, "  %-14s count=%zu min=%u p50=%u p90=%u p99=%u max=%u mean=%.1f\n",
+            label, _values.size(), _values.front(), pct(50), pct(90), pct(99),
+            _values.back(), (double)sum / _values.size());
+    if (!histogram) {
+      return;
+    }
+
+    static const uint32_t edges[] = {50, 100, 150, 200, 300, 500, 1000, 2000, 5000};
+    const size_t edgeCount = sizeof(edges) / sizeof(edges[0]);
+    size_t buckets[edgeCount + 1] = {0};
+    for (uint32_t v : _values) {
+      size_t b = 0;
+      while (b < edgeCount && v >= edges[b]) {
+        b++;
+      }
+      buckets[b]++;
+    }
+    fprintf(out, "  %-14s hist", "");
+    for (size_t b = 0; b <= edgeCount; b++) {
+      if (b < edgeCount) {
+        fprintf(out, " <%u:%zu", edges[b], buckets[b]);
+      } else {
+        fprintf(out, " >=%u:%zu", edges[edgeCount - 1], buckets[b]);
+      }
+    }
+    fprintf(out, "\n");
+  }
+
+private:
+  std::vector<uint32_t> _values;
+
+  uint32_t pct(uint32_t p) const {
+    size_t i = (size_t)((uint64_t)(_values.size() - 1) * p / 100);
+    return _values[i];
+  }
+};
+
+class LogAnalyzer {
+public:
+  explicit LogAnalyzer(const AnalyzerConfig& config) : _config(config) {}
+
+  void add(const LogRecord& r) {
+    _lines++;
+    if (r.hasHostTime) {
+      _hostSeen = true;
+      _lastHostMs = unwrapHost(r.hostMs);
+    }
+
+    switch (r.kind) {
+      case REC_EVENT:
+        onEvent(r);
+        break;
+      case REC_EVENT_DONE:
+        if (_hasPending && _pending.hasHost && r.hasHostTime) {
+          _sendDuration.add((uint32_t)(_lastHostMs - _pending.hostMs));
+        }
+        break;
+      case REC_BOOT_PHASE:
+        onBootPhase(r);
+        break;
+      case REC_STALL:
+      case REC_STALL_WDT:
+        onStall(r);
+        break;
+      case REC_OTHER:
+        break;
+      default:
+        if (r.kind == REC_STATS) {
+          _statsLines++;
+        }
+        onLinkRecord(r);
+        break;
+    }
+  }
+
+  // Akış bitti: bekleyen event'i işle
+  void finish() {
+    flushPending();
+    closeSession();
+  }
+
+  void report(FILE* out) {
+    fprintf(out, "== summary ==\n");
+    fprintf(out, "  lines=%llu events=%llu sessions=%zu host_time=%s\n",
+            (unsigned long long)_lines, (unsigned long long)_events, _sessions.size(),
+            _hostSeen ? "yes" : "no");
+    for (uint8_t t = 0; t < LOG_EVENT_TYPE_COUNT; t++) {
+      if (_typeCount[t] > 0) {
+        fprintf(out, "  %s=%llu", LOG_EVENT_NAMES[t], (unsigned long long)_typeCount[t]);
+      }
+    }
+    fprintf(out, "\n");
+
+    fprintf(out, "\n== intervals (ms, same type, device ts) ==\n");
+    for (uint8_t t = 0; t < LOG_EVENT_TYPE_COUNT; t++) {
+      _intervals[t].print(out, LOG_EVENT_NAMES[t]);
+    }
+    _allIntervals.print(out, "ANY");
+    _aiHold.print(out, "AI_HOLD");
+    _settleDelay.print(out, "ROTATE->SETTLE");
+
+    fprintf(out, "\n== velocity (steps/s, rotate events with v) ==\n");
+    _velocity[LOG_MAIN_ROTATE].print(out, "MAIN_ROTATE", false);
+    _velocity[LOG_SUB_ROTATE].print(out, "SUB_ROTATE", false);
+
+    fprintf(out, "\n== rate limit (limit=%ums) ==\n", _config.rateLimitMs);
+    for (uint8_t t = LOG_MAIN_ROTATE; t <= LOG_SUB_ROTATE; t++) {
+      size_t n = _intervals[t].count();
+      fprintf(out, "  %-14s intervals=%zu at_limit=%llu (%.1f%%) below_limit=%llu\n",
+              LOG_EVENT_NAMES[t], n, (unsigned long long)_atLimit[t],
+              n > 0 ? 100.0 * _atLimit[t] / n : 0.0, (unsigned long long)_belowLimit[t]);
+    }
+    fprintf(out, "  at_limit: aralık [%u,%u) ms, kullanıcı limitten hızlı çeviriyor (adımlar atlanır)\n",
+            _config.rateLimitMs, _config.rateLimitMs + _config.nearLimitMs);
+
+    fprintf(out, "\n== continuity ==\n");
+    fprintf(out, "  index_jumps=%llu missing_steps=%llu seq_gaps=%llu missing_seq=%llu\n",
+            (unsigned long long)_indexJumps, (unsigned long long)_missingSteps,
+            (unsigned long long)_seqGaps, (unsigned long long)_missingSeq);
+
+    fprintf(out, "\n== blocking (host time) ==\n");
+    if (!_hostSeen) {
+      fprintf(out, "  host zaman damgası yok (ör. pio device monitor --filter time)\n");
+    } else {
+      _sendDuration.print(out, "sendEvent");
+      _lag.print(out, "host_lag");
+      fprintf(out, "  gaps>=%ums: %zu\n", _config.gapMs, _gapCount);
+      for (const Gap& g : _gaps) {
+        fprintf(out, "  gap session=%zu ts=%u lag=%ums host_dt=%ums dev_dt=%ums\n",
+                g.session, g.ts, g.lagMs, g.hostDt, g.devDt);
+      }
+    }
+
+    fprintf(out, "\n== stalls (device [STALL], loop budget) ==\n");
+    _stallLoop.print(out, "loop_us", false);
+    for (const StallStage& st : _stallStages) {
+      fprintf(out, "  stage=%-12s reported=%llu max_stage_us=%u\n", st.name.c_str(),
+              (unsigned long long)st.count, st.maxStageUs);
+    }
+    fprintf(out, "  wdt=%llu\n", (unsigned long long)_stallWdt);
+    for (const std::string& w : _wdtLines) {
+      fprintf(out, "  %s\n", w.c_str());
+    }
+    fprintf(out, "  not: cihaz saniyede en fazla bir stall satırı basar (en kötüsü); toplam sayı için [STALL] stats\n");
+
+    fprintf(out, "\n== sessions ==\n");
+    for (size_t i = 0; i < _sessions.size(); i++) {
+      printSession(out, i, _sessions[i]);
+    }
+
+    if (_config.printTimeline) {
+      fprintf(out, "\n== timeline ==\n");
+      for (const TimelineEntry& e : _timeline) {
+        if (e.hasHost) {
+          fprintf(out, "  s%zu ~%8ums host=%s  %s\n", e.session, e.deviceMs,
+                  formatHost(e.hostMs).c_str(), e.text.c_str());
+        } else {
+          fprintf(out, "  s%zu ~%8ums  %s\n", e.session, e.deviceMs, e.text.c_str());
+        }
+      }
+    }
+  }
+
+private:
+  struct PendingEvent {
+    uint8_t type = 0;
+    int32_t mainIndex = 0;
+    int32_t subIndex = -1;
+    uint32_t ts = 0;
+    bool hasSeq = false;
+    uint32_t seq = 0;
+    bool fromTransport = false;
+    int32_t velocity = -1;
+    bool hasHost = false;
+    int64_t hostMs = 0;
+  };
+
+  struct Session {
+    uint64_t events = 0;
+    uint32_t firstTs = 0;
+    uint32_t lastTs = 0;
+    uint32_t pairingOn = 0;
+    uint32_t connects = 0;
+    uint32_t disconnects = 0;
+    uint32_t advRestarts = 0;
+    uint32_t bleOff = 0;
+    int32_t maxPeers = 0;
+    bool hasBleStart = false;
+    uint32_t bleStartMs = 0;
+    bool hasFirstConnect = false;
+    uint32_t firstConnectMs = 0;
+    int64_t bleStartHost = -1;
+    int64_t firstConnectHost = -1;
+    std::string bootPhases;
+  };
+
+  struct Gap {
+    size_t session;
+    uint32_t ts;
+    uint32_t lagMs;
+    uint32_t hostDt;
+    uint32_t devDt;
+  };
+
+  struct StallStage {
+    std::string name;
+    uint64_t count;
+    uint32_t maxStageUs;
+  };
+
+  struct TimelineEntry {
+    size_t session;
+    uint32_t deviceMs;
+    bool hasHost;
+    int64_t hostMs;
+    std::string text;
+  };
+
+  AnalyzerConfig _config;
+  uint64_t _lines = 0;
+  uint64_t _events = 0;
+  uint64_t _statsLines = 0;
+  uint64_t _typeCount[LOG_EVENT_TYPE_COUNT] = {0};
+
+  // Host zamanı (gece yarısı dönüşü açılmış)
+  bool _hostSeen = false;
+  int64_t _hostDayOffset = 0;
+  int64_t _lastRawHost = -1;
+  int64_t _lastHostMs = 0;
+
+  // Event birleştirme
+  bool _hasPending = false;
+  PendingEvent _pending;
+
+  // Oturum durumu
+  std::vector<Session> _sessions;
+  bool _sessionOpen = false;
+  uint32_t _deviceMs = 0;          // Oturumdaki son bilinen cihaz zamanı
+  bool _hasPrev = false;
+  PendingEvent _prev;
+  bool _hasPrevType[LOG_EVENT_TYPE_COUNT] = {false};
+  uint32_t _prevTypeTs[LOG_EVENT_TYPE_COUNT] = {0};
+  bool _hasModel = false;
+  int32_t _modelMain = 0;
+  int32_t _modelSub = 0;
+  bool _hasSeq = false;
+  uint32_t _lastSeq = 0;
+  bool _aiDown = false;
+  uint32_t _aiDownTs = 0;
+  bool _hasRotate = false;
+  uint32_t _lastRotateTs = 0;
+
+  // Sonuçlar
+  Distribution _intervals[LOG_EVENT_TYPE_COUNT];
+  Distribution _allIntervals;
+  Distribution _aiHold;
+  Distribution _settleDelay;
+  Distribution _velocity[LOG_EVENT_TYPE_COUNT];
+  Distribution _sendDuration;
+  Distribution _lag;
+  uint64_t _atLimit[LOG_EVENT_TYPE_COUNT] = {0};
+  uint64_t _belowLimit[LOG_EVENT_TYPE_COUNT] = {0};
+  uint64_t _indexJumps = 0;
+  uint64_t _missingSteps = 0;
+  uint64_t _seqGaps = 0;
+  uint64_t _missingSeq = 0;
+  std::vector<Gap> _gaps;
+  size_t _gapCount = 0;
+  std::vector<TimelineEntry> _timeline;
+  Distribution _stallLoop;
+  std::vector<StallStage> _stallStages;
+  uint64_t _stallWdt = 0;
+  std::vector<std::string> _wdtLines;
+
+  int64_t unwrapHost(int64_t raw) {
+    // Gün dönümü: saat 12 saatten fazla geri gittiyse bir gün ekle
+    if (_lastRawHost >= 0 && raw + 12LL * 3600 * 1000 < _lastRawHost) {
+      _hostDayOffset += 24LL * 3600 * 1000;
+    }
+    _lastRawHost = raw;
+    return raw + _hostDayOffset;
+  }
+
+  Session& session() {
+    if (!_sessionOpen) {
+      openSession();
+    }
+    return _sessions.back();
+  }
+
+  void openSession() {
+    _sessions.push_back(Session());
+    _sessionOpen = true;
+    _deviceMs = 0;
+    _hasPrev = false;
+    for (uint8_t t = 0; t < LOG_EVENT_TYPE_COUNT; t++) {
+      _hasPrevType[t] = false;
+    }
+    _hasModel = false;
+    _hasSeq = false;
+    _aiDown = false;
+    _hasRotate = false;
+  }
+
+  void closeSession() {
+    _sessionOpen = false;
+  }
+
+  // ---------------- Event'ler ----------------
+
+  void onEvent(const LogRecord& r) {
+    // main.cpp [DEBUG] satırı + transport [BLE] satırı aynı event
+    if (_hasPending && !_pending.fromTransport && r.fromTransport &&
+        _pending.type == r.type && _pending.ts == r.ts) {
+      _pending.fromTransport = true;
+      if (r.hasSeq) {
+        _pending.hasSeq = true;
+        _pending.seq = r.seq;
+      }
+      if (r.velocity >= 0) {
+        _pending.velocity = r.velocity;
+      }
+      return;
+    }
+    flushPending();
+    _pending = PendingEvent();
+    _pending.type = r.type;
+    _pending.mainIndex = r.mainIndex;
+    _pending.subIndex = r.subIndex;
+    _pending.ts = r.ts;
+    _pending.hasSeq = r.hasSeq;
+    _pending.seq = r.seq;
+    _pending.fromTransport = r.fromTransport;
+    _pending.velocity = r.velocity;
+    _pending.hasHost = r.hasHostTime;
+    _pending.hostMs = _lastHostMs;
+    _hasPending = true;
+  }
+
+  void flushPending() {
+    if (!_hasPending) {
+      return;
+    }
+    _hasPending = false;
+    commitEvent(_pending);
+  }
+
+  void commitEvent(const PendingEvent& e) {
+    // ts geri gittiyse cihaz [BOOT] logu olmadan yeniden başlamış
+    if (_sessionOpen && _hasPrev && e.ts + 1000 < _prev.ts) {
+      closeSession();
+    }
+    Session& s = session();
+    size_t sessionIndex = _sessions.size() - 1;
+    if (s.events == 0) {
+      s.firstTs = e.ts;
+    }
+    s.events++;
+    s.lastTs = e.ts;
+    _deviceMs = e.ts;
+    _events++;
+    _typeCount[e.type]++;
+
+    if (_config.printEvents) {
+      printf("event s%zu ts=%u %s m=%d", sessionIndex, e.ts, LOG_EVENT_NAMES[e.type], e.mainIndex);
+      if (e.subIndex >= 0) printf(" s=%d", e.subIndex);
+      if (e.velocity >= 0) printf(" v=%d", e.velocity);
+      if (e.hasSeq) printf(" seq=%u", e.seq);
+      printf("\n");
+    }
+
+    // Aralıklar
+    if (_hasPrevType[e.type]) {
+      uint32_t dt = e.ts - _prevTypeTs[e.type];
+      _intervals[e.type].add(dt);
+      if (e.type == LOG_MAIN_ROTATE || e.type == LOG_SUB_ROTATE) {
+        if (dt < _config.rateLimitMs) {
+          _belowLimit[e.type]++;
+        } else if (dt < _config.rateLimitMs + _config.nearLimitMs) {
+          _atLimit[e.type]++;
+        }
+      }
+    }
+    _hasPrevType[e.type] = true;
+    _prevTypeTs[e.type] = e.ts;
+
+    if (_hasPrev) {
+      _allIntervals.add(e.ts - _prev.ts);
+      if (e.hasHost && _prev.hasHost) {
+        int64_t hostDt = e.hostMs - _prev.hostMs;
+        int64_t devDt = (int64_t)(e.ts - _prev.ts);
+        int64_t lag = hostDt - devDt;
+        if (lag < 0) lag = 0;
+        _lag.add((uint32_t)lag);
+        if (lag >= _config.gapMs) {
+          addGap({sessionIndex, e.ts, (uint32_t)lag, (uint32_t)hostDt, (uint32_t)devDt});
+        }
+      }
+    }
+
+    // Hız ipucu ve SETTLE gecikmesi (dwell + loop gecikmesi)
+    if (e.type == LOG_MAIN_ROTATE || e.type == LOG_SUB_ROTATE) {
+      if (e.velocity >= 0) {
+        _velocity[e.type].add((uint32_t)e.velocity);
+      }
+      _hasRotate = true;
+      _lastRotateTs = e.ts;
+    } else if (e.type == LOG_SETTLE && _hasRotate) {
+      _settleDelay.add(e.ts - _lastRotateTs);
+      _hasRotate = false;
+    }
+
+    // AI basılı tutma süresi
+    if (e.type == LOG_AI_PRESS) {
+      _aiDown = true;
+      _aiDownTs = e.ts;
+    } else if (e.type == LOG_AI_RELEASE && _aiDown) {
+      _aiHold.add(e.ts - _aiDownTs);
+      _aiDown = false;
+    }
+
+    checkContinuity(e);
+    _prev = e;
+    _hasPrev = true;
+  }
+
+  // uint8 index'te iki değer arası en kısa adım sayısı
+  static uint32_t stepDistance(int32_t a, int32_t b) {
+    int32_t d = ((b - a) % 256 + 256) % 256;
+    return (uint32_t)std::min(d, 256 - d);
+  }
+
+  // Firmware modeli: MAIN ±1 (sub sıfırlanır), SUB ±1, butonlar mevcut pozisyonu taşır
+  void checkContinuity(const PendingEvent& e) {
+    if (_hasModel) {
+      uint32_t missing = 0;
+      bool jump = false;
+      if (e.type == LOG_MAIN_ROTATE) {
+        uint32_t d = stepDistance(_modelMain, e.mainIndex);
+        jump = d != 1;
+        missing = d > 1 ? d - 1 : 0;
+      } else if (e.type == LOG_SUB_ROTATE) {
+        uint32_t dm = stepDistance(_modelMain, e.mainIndex);
+        uint32_t ds = stepDistance(_modelSub, e.subIndex);
+        jump = dm != 0 || ds != 1;
+        missing = dm + (ds > 1 ? ds - 1 : 0);
+      } else {
+        uint32_t dm = stepDistance(_modelMain, e.mainIndex);
+        uint32_t ds = e.subIndex >= 0 ? stepDistance(_modelSub, e.subIndex) : 0;
+        jump = dm != 0 || ds != 0;
+        missing = dm + ds;
+      }
+      if (jump) {
+        _indexJumps++;
+        _missingSteps += missing;
+      }
+    }
+    _hasModel = true;
+    _modelMain = e.mainIndex;
+    if (e.type == LOG_MAIN_ROTATE) {
+      _modelSub = 0;
+    } else if (e.subIndex >= 0) {
+      _modelSub = e.subIndex;
+    }
+
+    if (e.hasSeq) {
+      if (_hasSeq && e.seq != _lastSeq + 1) {
+        _seqGaps++;
+        if (e.seq > _lastSeq) {
+          _missingSeq += e.seq - _lastSeq - 1;
+        }
+      }
+      _hasSeq = true;
+      _lastSeq = e.seq;
+    }
+  }
+
+  void addGap(const Gap& g) {
+    _gapCount++;
+    _gaps.push_back(g);
+    std::sort(_gaps.begin(), _gaps.end(), [](const Gap& a, const Gap& b) {
+      return a.lagMs > b.lagMs;
+    });
+    if (_gaps.size() > _config.topGaps) {
+      _gaps.pop_back();
+    }
+  }
+
+  // ---------------- Boot / bağlantı ----------------
+
+  void onBootPhase(const LogRecord& r) {
+    std::string name(r.phase, r.phaseLen);
+    if (name == "setup_start") {
+      flushPending();
+      closeSession();
+    }
+    Session& s = session();
+    uint32_t ms = r.bootUs / 1000;
+    if (ms > _deviceMs) {
+      _deviceMs = ms;
+    }
+    if (name != "setup_start") {
+      char buf[64];
+      snprintf(buf, sizeof(buf), " %s=%uus", name.c_str(), r.bootUs);
+      s.bootPhases += buf;
+    }
+    addTimeline(r);
+  }
+
+  // ---------------- Stall ----------------
+
+  void onStall(const LogRecord& r) {
+    flushPending();
+    session();
+    std::string name(r.stage, r.stageLen);
+    if (r.kind == REC_STALL_WDT) {
+      _stallWdt++;
+      char buf[32];
+      snprintf(buf, sizeof(buf), "s%zu ", _sessions.size() - 1);
+      _wdtLines.push_back(buf + std::string(r.text, r.textLen));
+      addTimeline(r);
+      return;
+    }
+    if (r.stallMs > _deviceMs) {
+      _deviceMs = r.stallMs;
+    }
+    _stallLoop.add(r.loopUs);
+    StallStage* st = nullptr;
+    for (StallStage& s : _stallStages) {
+      if (s.name == name) {
+        st = &s;
+        break;
+      }
+    }
+    if (st == nullptr) {
+      _stallStages.push_back({name, 0, 0});
+      st = &_stallStages.back();
+    }
+    st->count++;
+    if (r.stageUs > st->maxStageUs) {
+      st->maxStageUs = r.stageUs;
+    }
+    addTimeline(r);
+  }
+
+  void onLinkRecord(const LogRecord& r) {
+    // Bağlantı satırları event'ten önce/sonra gelir; sıra için bekleyen event'i işle
+    flushPending();
+    Session& s = session();
+    int64_t host = r.hasHostTime ? _lastHostMs : -1;
+    switch (r.kind) {
+      case REC_BLE_START:
+        if (!s.hasBleStart) {
+          s.hasBleStart = true;
+          s.bleStartMs = _deviceMs;
+          s.bleStartHost = host;
+        }
+        break;
+      case REC_PAIRING_ON:
+        s.pairingOn++;
+        break;
+      case REC_CONNECT:
+        s.connects++;
+        if (r.count > s.maxPeers) s.maxPeers = r.count;
+        if (!s.hasFirstConnect) {
+          s.hasFirstConnect = true;
+          s.firstConnectMs = _deviceMs;
+          s.firstConnectHost = host;
+        }
+        break;
+      case REC_DISCONNECT:
+        s.disconnects++;
+        break;
+      case REC_ADV_RESTART:
+        s.advRestarts++;
+        break;
+      case REC_BLE_OFF:
+        s.bleOff++;
+        break;
+      default:
+        break;
+    }
+    if (r.kind != REC_STATS) {
+      addTimeline(r);
+    }
+  }
+
+  void addTimeline(const LogRecord& r) {
+    if (!_config.printTimeline) {
+      return;
+    }
+    TimelineEntry e;
+    e.session = _sessions.size() - 1;
+    e.deviceMs = _deviceMs;
+    e.hasHost = r.hasHostTime;
+    e.hostMs = _lastHostMs;
+    e.text.assign(r.text, r.textLen);
+    _timeline.push_back(e);
+  }
+
+  void printSession(FILE* out, size_t index, const Session& s) {
+    fprintf(out, "  s%zu events=%llu ts=%u..%u pairing=%u connects=%u disconnects=%u max_peers=%d adv_restarts=%u ble_off=%u\n",
+            index, (unsigned long long)s.events, s.firstTs, s.lastTs, s.pairingOn,
+            s.connects, s.disconnects, s.maxPeers, s.advRestarts, s.bleOff);
+    if (!s.bootPhases.empty()) {
+      fprintf(out, "     boot%s\n", s.bootPhases.c_str());
+    }
+    if (s.hasBleStart && s.hasFirstConnect) {
+      if (s.bleStartHost >= 0 && s.firstConnectHost >= 0) {
+        fprintf(out, "     ble_start->first_connect=%lldms (host)\n",
+                (long long)(s.firstConnectHost - s.bleStartHost));
+      } else {
+        fprintf(out, "     ble_start->first_connect~%ums (device, son event ts'ine göre)\n",
+                s.firstConnectMs - s.bleStartMs);
+      }
+    }
+  }
+
+  static std::string formatHost(int64_t ms) {
+    char buf[32];
+    int64_t day = ms / (24LL * 3600 * 1000);
+    int64_t t = ms % (24LL * 3600 * 1000);
+    snprintf(buf, sizeof(buf), "%s%02lld:%02lld:%02lld.%03lld", day > 0 ? "+" : "",
+             (long long)(t / 3600000), (long long)(t / 60000 % 60),
+             (long long)(t / 1000 % 60), (long long)(t % 1000));
+    return buf;
+  }
+};
+
+#endif // LOG_ANALYZER_H
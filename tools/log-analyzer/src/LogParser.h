@@ -0,0 +1,356 @@
+#ifndef LOG_PARSER_H
+#define LOG_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/* =========================================================
+   LOG PARSER (Cihaz Serial Satırlarını Sınıflandırma)
+   =========================================================
+
+   Tek bir log satırını (satır sonu hariç) LogRecord'a çevirir.
+   Bellek ayırmaz, satırı kopyalamaz; çok saatlik kayıtlarda
+   satır başına sadece birkaç memcmp yapılır.
+
+   Tanınan satırlar (firmware'deki formatlar):
+   - [DEBUG] sendEvent çağrıldı: type=0 m=1 s=0 ts=1234
+   - [BLE] {"type":0,"mainIndex":1,"subIndex":0,"ts":1234,"seq":7,...}
+   - [BLE] MAIN_ROTATE m=1 v=4 ts=1234      (SerialEventTransport)
+   - [BOOT] phase=input_armed t=1834us
+   - [BLE] Pairing mode aktif / sona erdi, Cihaz bağlandı / Bağlantı
+     kesildi (bağlı cihaz: N), advertising ve Bluetooth aç/kapa
+   - [BLE] stats ... / [BLE] peer ... / [BLE] link ...
+   - [STALL] loop=7421us budget=5000us stage=send stage_us=6900 t=12345ms
+   - [STALL] wdt hits=1 stage=.. / [STALL] reset=TASK_WDT last_stage=..
+
+   Satır başındaki host zaman damgası (Arduino IDE "12:34:56.789 -> ",
+   PlatformIO monitor --filter time "12:34:56.789 > ") varsa ayrıştırılır.
+*/
+
+enum RecordKind : uint8_t {
+  REC_OTHER = 0,
+  REC_EVENT,          // Kullanıcı event'i (type/m/s/ts, varsa seq)
+  REC_EVENT_DONE,     // [DEBUG] sendEvent tamamlandı
+  REC_BOOT_PHASE,     // [BOOT] phase=.. t=..us
+  REC_BOOT_SUMMARY,   // [BOOT] summary ...
+  REC_BLE_START,      // Bluetooth başlatılıyor
+  REC_BLE_OFF,        // Bluetooth kapatıldı
+  REC_ADV_START,      // Advertising başlatıldı
+  REC_ADV_RESTART,    // Yeniden advertising başlatıldı
+  REC_PAIRING_ON,     // Pairing mode aktif
+  REC_PAIRING_OFF,    // Pairing mode sona erdi
+  REC_CONNECT,        // Cihaz bağlandı (count = bağlı cihaz sayısı)
+  REC_DISCONNECT,     // Bağlantı kesildi (count = kalan cihaz sayısı)
+  REC_STATS,          // [BLE] stats / peer / link, [STALL] stats
+  REC_STALL,          // [STALL] loop=..us stage=.. (bütçeyi aşan loop turu)
+  REC_STALL_WDT,      // [STALL] wdt / reset=..: watchdog takılan aşamayı yakaladı
+  REC_KIND_COUNT
+};
+
+// Firmware'deki EventType ile aynı sıra
+enum LogEventType : uint8_t {
+  LOG_MAIN_ROTATE = 0,
+  LOG_SUB_ROTATE,
+  LOG_CONFIRM,
+  LOG_CANCEL,
+  LOG_AI_PRESS,
+  LOG_AI_RELEASE,
+  LOG_SETTLE,
+  LOG_EVENT_TYPE_COUNT
+};
+
+static const char* const LOG_EVENT_NAMES[LOG_EVENT_TYPE_COUNT] = {
+  "MAIN_ROTATE", "SUB_ROTATE", "CONFIRM", "CANCEL", "AI_PRESS", "AI_RELEASE", "SETTLE"
+};
+
+struct LogRecord {
+  RecordKind kind = REC_OTHER;
+  bool hasHostTime = false;
+  int64_t hostMs = 0;        // Host zaman damgası (gün içi ms)
+
+  // REC_EVENT
+  uint8_t type = 0;
+  int32_t mainIndex = 0;
+  int32_t subIndex = -1;     // Kompakt formatta MAIN_ROTATE için yok
+  uint32_t ts = 0;           // Cihaz millis()
+  bool hasSeq = false;
+  uint32_t seq = 0;
+  bool fromTransport = false; // [BLE] satırı (false: main.cpp [DEBUG] satırı)
+  int32_t velocity = -1;     // Rotate event'lerinde "v" (adım/sn), yoksa -1
+
+  // REC_BOOT_PHASE
+  const char* phase = nullptr;
+  size_t phaseLen = 0;
+  uint32_t bootUs = 0;
+
+  // REC_CONNECT / REC_DISCONNECT
+  int32_t count = -1;
+
+  // REC_STALL / REC_STALL_WDT
+  const char* stage = nullptr;
+  size_t stageLen = 0;
+  uint32_t loopUs = 0;
+  uint32_t stageUs = 0;
+  uint32_t stallMs = 0;      // Cihaz millis() (sadece REC_STALL)
+
+  // Ham satır (timeline çıktısı için)
+  const char* text = nullptr;
+  size_t textLen = 0;
+};
+
+class LogParser {
+public:
+  // Satırı ayrıştır. line: satır başı, len: '\n' ve '\r' hariç uzunluk
+  static LogRecord parse(const char* line, size_t len) {
+    LogRecord r;
+    const char* end = line + len;
+    const char* p = parseHostTime(line, end, &r);
+    r.text = p;
+    r.textLen = end - p;
+
+    if (startsWith(p, end, "[BLE] ")) {
+      parseBle(p + 6, end, &r);
+    } else if (startsWith(p, end, "[DEBUG] ")) {
+      parseDebug(p + 8, end, &r);
+    } else if (startsWith(p, end, "[BOOT] ")) {
+      parseBoot(p + 7, end, &r);
+    } else if (startsWith(p, end, "[STALL] ")) {
+      parseStall(p + 8, end, &r);
+    }
+    return r;
+  }
+
+  static bool startsWith(const char* p, const char* end, const char* prefix) {
+    size_t n = strlen(prefix);
+    return (size_t)(end - p) >= n && memcmp(p, prefix, n) == 0;
+  }
+
+  // [p, end) içinde key'i bul (memmem yerine, taşınabilir)
+  static const char* find(const char* p, const char* end, const char* key) {
+    size_t n = strlen(key);
+    if (n == 0 || (size_t)(end - p) < n) {
+      return nullptr;
+    }
+    const char* last = end - n;
+    while (p <= last) {
+      const char* hit = (const char*)memchr(p, key[0], last - p + 1);
+      if (hit == nullptr) {
+        return nullptr;
+      }
+      if (memcmp(hit, key, n) == 0) {
+        return hit;
+      }
+      p = hit + 1;
+    }
+    return nullptr;
+  }
+
+  // key'den sonraki (işaretli) tamsayıyı oku
+  static bool intAfter(const char* p, const char* end, const char* key, int64_t* out) {
+    const char* hit = find(p, end, key);
+    if (hit == nullptr) {
+      return false;
+    }
+    return parseInt(hit + strlen(key), end, out);
+  }
+
+  static bool parseInt(const char* p, const char* end, int64_t* out) {
+    bool neg = false;
+    if (p < end && *p == '-') {
+      neg = true;
+      p++;
+    }
+    if (p >= end || *p < '0' || *p > '9') {
+      return false;
+    }
+    int64_t v = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+      v = v * 10 + (*p - '0');
+      p++;
+    }
+    *out = neg ? -v : v;
+    return true;
+  }
+
+private:
+  // "HH:MM:SS.mmm -> " veya "HH:MM:SS.mmm > " öneki
+  static const char* parseHostTime(const char* p, const char* end, LogRecord* r) {
+    if (end - p < 12 || p[2] != ':' || p[5] != ':' || p[8] != '.') {
+      return p;
+    }
+    static const int digits[] = {0, 1, 3, 4, 6, 7, 9, 10, 11};
+    for (int i : digits) {
+      if (p[i] < '0' || p[i] > '9') {
+        return p;
+      }
+    }
+    int64_t h = (p[0] - '0') * 10 + (p[1] - '0');
+    int64_t m = (p[3] - '0') * 10 + (p[4] - '0');
+    int64_t s = (p[6] - '0') * 10 + (p[7] - '0');
+    int64_t ms = (p[9] - '0') * 100 + (p[10] - '0') * 10 + (p[11] - '0');
+    const char* q = p + 12;
+    if (startsWith(q, end, " -> ")) {
+      q += 4;
+    } else if (startsWith(q, end, " > ")) {
+      q += 3;
+    } else {
+      return p;
+    }
+    r->hasHostTime = true;
+    r->hostMs = ((h * 60 + m) * 60 + s) * 1000 + ms;
+    return q;
+  }
+
+  static void parseBle(const char* p, const char* end, LogRecord* r) {
+    if (p < end && *p == '{') {
+      parseJsonEvent(p, end, r);
+      return;
+    }
+    for (uint8_t t = 0; t < LOG_EVENT_TYPE_COUNT; t++) {
+      const char* name = LOG_EVENT_NAMES[t];
+      size_t n = strlen(name);
+      if ((size_t)(end - p) > n && memcmp(p, name, n) == 0 && p[n] == ' ') {
+        parseCompactEvent(t, p + n, end, r);
+        return;
+      }
+    }
+    if (startsWith(p, end, "stats ") || startsWith(p, end, "peer ") || startsWith(p, end, "link ")) {
+      r->kind = REC_STATS;
+    } else if (startsWith(p, end, "Cihaz bağlandı")) {
+      r->kind = REC_CONNECT;
+      countAfter(p, end, r);
+    } else if (startsWith(p, end, "Bağlantı kesildi")) {
+      r->kind = REC_DISCONNECT;
+      countAfter(p, end, r);
+    } else if (startsWith(p, end, "Pairing mode aktif")) {
+      r->kind = REC_PAIRING_ON;
+    } else if (startsWith(p, end, "Pairing mode sona erdi")) {
+      r->kind = REC_PAIRING_OFF;
+    } else if (startsWith(p, end, "Advertising başlatıldı")) {
+      r->kind = REC_ADV_START;
+    } else if (startsWith(p, end, "Yeniden advertising başlatıldı")) {
+      r->kind = REC_ADV_RESTART;
+    } else if (startsWith(p, end, "Bluetooth başlatılıyor")) {
+      r->kind = REC_BLE_START;
+    } else if (startsWith(p, end, "Bluetooth kapatıldı")) {
+      r->kind = REC_BLE_OFF;
+    }
+  }
+
+  static void countAfter(const char* p, const char* end, LogRecord* r) {
+    int64_t v;
+    if (intAfter(p, end, "bağlı cihaz: ", &v)) {
+      r->count = (int32_t)v;
+    }
+  }
+
+  static void parseJsonEvent(const char* p, const char* end, LogRecord* r) {
+    int64_t type, m, s, ts, seq, v;
+    if (!intAfter(p, end, "\"type\":", &type) || !intAfter(p, end, "\"ts\":", &ts) ||
+        type < 0 || type >= LOG_EVENT_TYPE_COUNT) {
+      return;
+    }
+    r->kind = REC_EVENT;
+    r->fromTransport = true;
+    r->type = (uint8_t)type;
+    r->ts = (uint32_t)ts;
+    if (intAfter(p, end, "\"mainIndex\":", &m)) r->mainIndex = (int32_t)m;
+    if (intAfter(p, end, "\"subIndex\":", &s)) r->subIndex = (int32_t)s;
+    if (intAfter(p, end, "\"v\":", &v)) r->velocity = (int32_t)v;
+    if (intAfter(p, end, "\"seq\":", &seq)) {
+      r->hasSeq = true;
+      r->seq = (uint32_t)seq;
+    }
+  }
+
+  static void parseCompactEvent(uint8_t type, const char* p, const char* end, LogRecord* r) {
+    int64_t m, s, ts, v;
+    if (!intAfter(p, end, "ts=", &ts)) {
+      return;
+    }
+    r->kind = REC_EVENT;
+    r->fromTransport = true;
+    r->type = type;
+    r->ts = (uint32_t)ts;
+    if (intAfter(p, end, "m=", &m)) r->mainIndex = (int32_t)m;
+    if (intAfter(p, end, " s=", &s)) r->subIndex = (int32_t)s;
+    if (intAfter(p, end, " v=", &v)) r->velocity = (int32_t)v;
+  }
+
+  static void parseDebug(const char* p, const char* end, LogRecord* r) {
+    // Sadece main.cpp'deki satır; transport'un "[DEBUG] XEventTransport.sendEvent" satırı değil
+    if (startsWith(p, end, "sendEvent çağrıldı:")) {
+      int64_t type, m, s, ts;
+      if (intAfter(p, end, "type=", &type) && intAfter(p, end, "ts=", &ts) &&
+          type >= 0 && type < LOG_EVENT_TYPE_COUNT) {
+        r->kind = REC_EVENT;
+        r->type = (uint8_t)type;
+        r->ts = (uint32_t)ts;
+        if (intAfter(p, end, " m=", &m)) r->mainIndex = (int32_t)m;
+        if (intAfter(p, end, " s=", &s)) r->subIndex = (int32_t)s;
+      }
+    } else if (startsWith(p, end, "sendEvent tamamlandı")) {
+      r->kind = REC_EVENT_DONE;
+    }
+  }
+
+  static void parseBoot(const char* p, const char* end, LogRecord* r) {
+    if (startsWith(p, end, "summary ")) {
+      r->kind = REC_BOOT_SUMMARY;
+      return;
+    }
+    if (!startsWith(p, end, "phase=")) {
+      return;
+    }
+    const char* name = p + 6;
+    const char* sp = (const char*)memchr(name, ' ', end - name);
+    int64_t us;
+    if (sp == nullptr || !intAfter(sp, end, "t=", &us)) {
+      return;
+    }
+    r->kind = REC_BOOT_PHASE;
+    r->phase = name;
+    r->phaseLen = sp - name;
+    r->bootUs = (uint32_t)us;
+  }
+
+  static void parseStall(const char* p, const char* end, LogRecord* r) {
+    if (startsWith(p, end, "stats ")) {
+      r->kind = REC_STATS;
+      return;
+    }
+    const char* key = nullptr;
+    if (startsWith(p, end, "loop=")) {
+      int64_t loop, stageUs, t;
+      if (!intAfter(p, end, "loop=", &loop) || !intAfter(p, end, "stage_us=", &stageUs) ||
+          !intAfter(p, end, " t=", &t)) {
+        return;
+      }
+      r->kind = REC_STALL;
+      r->loopUs = (uint32_t)loop;
+      r->stageUs = (uint32_t)stageUs;
+      r->stallMs = (uint32_t)t;
+      key = " stage=";
+    } else if (startsWith(p, end, "wdt ")) {
+      r->kind = REC_STALL_WDT;
+      key = " stage=";
+    } else if (startsWith(p, end, "reset=")) {
+      r->kind = REC_STALL_WDT;
+      key = " last_stage=";
+    } else {
+      return;
+    }
+    const char* name = find(p, end, key);
+    if (name == nullptr) {
+      r->kind = REC_OTHER;
+      return;
+    }
+    name += strlen(key);
+    const char* sp = (const char*)memchr(name, ' ', end - name);
+    r->stage = name;
+    r->stageLen = (sp != nullptr ? sp : end) - name;
+  }
+};
+
+#endif // LOG_PARSER_H
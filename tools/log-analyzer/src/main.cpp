@@ -0,0 +1,145 @@
+/*
+ * ============================================================================
+ * EYA LOG ANALYZER - Cihaz Serial Log Analizi (Host Aracı)
+ * ============================================================================
+ *
+ * Serial monitör veya Wokwi kayıtlarını okuyup event dizisini ve zamanlama
+ * istatistiklerini çıkarır.
+ *
+ * Kullanım:
+ *   eya-log-analyzer [seçenekler] <log dosyası...>   ("-" = stdin)
+ *
+ * Seçenekler:
+ *   --rate-limit-ms N   Firmware EVENT_RATE_LIMIT_MS (varsayılan 100)
+ *   --gap-ms N          Blocking sayılacak host gecikmesi (varsayılan 50)
+ *   --timeline          Boot/pairing/bağlantı satırlarını zaman çizelgesi olarak bas
+ *   --events            Yeniden kurulan event dizisini bas
+ *
+ * Dosya 1MB'lık bloklar halinde okunur ve satırlar blok içinde yerinde
+ * ayrıştırılır (satır kopyası yok); çok saatlik kayıtlar saniyeler içinde
+ * işlenir ve boru (pio device monitor | eya-log-analyzer -) ile de çalışır.
+ * ============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "LogParser.h"
+#include "LogAnalyzer.h"
+
+static const size_t READ_BLOCK = 1 << 20;
+
+static void usage() {
+  fprintf(stderr,
+          "Kullanım: eya-log-analyzer [--rate-limit-ms N] [--gap-ms N] [--timeline] [--events] <log...|->\n");
+}
+
+// Dosyayı bloklar halinde oku, tam satırları analizöre ver.
+// Return: okunan byte sayısı, hata durumunda -1
+static long long processStream(FILE* in, LogAnalyzer& analyzer) {
+  std::vector<char> buf(READ_BLOCK);
+  size_t carry = 0;  // Önceki bloktan kalan yarım satır
+  long long total = 0;
+
+  while (true) {
+    if (carry == buf.size()) {
+      buf.resize(buf.size() * 2);  // Çok uzun satır (bozuk kayıt)
+    }
+    size_t n = fread(buf.data() + carry, 1, buf.size() - carry, in);
+    if (n == 0) {
+      break;
+    }
+    total += n;
+    const char* p = buf.data();
+    const char* end = buf.data() + carry + n;
+    while (true) {
+      const char* nl = (const char*)memchr(p, '\n', end - p);
+      if (nl == nullptr) {
+        break;
+      }
+      size_t len = nl - p;
+      if (len > 0 && p[len - 1] == '\r') {
+        len--;
+      }
+      analyzer.add(LogParser::parse(p, len));
+      p = nl + 1;
+    }
+    carry = end - p;
+    memmove(buf.data(), p, carry);
+  }
+
+  if (ferror(in)) {
+    return -1;
+  }
+  if (carry > 0) {
+    size_t len = carry;
+    if (buf[len - 1] == '\r') {
+      len--;
+    }
+    analyzer.add(LogParser::parse(buf.data(), len));
+  }
+  return total;
+}
+
+int main(int argc, char** argv) {
+  AnalyzerConfig config;
+  std::vector<const char*> files;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--rate-limit-ms") == 0 && i + 1 < argc) {
+      config.rateLimitMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--gap-ms") == 0 && i + 1 < argc) {
+      config.gapMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--timeline") == 0) {
+      config.printTimeline = true;
+    } else if (strcmp(arg, "--events") == 0) {
+      config.printEvents = true;
+    } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+      usage();
+      return 0;
+    } else if (arg[0] == '-' && arg[1] != '\0') {
+      fprintf(stderr, "Bilinmeyen seçenek: %s\n", arg);
+      usage();
+      return 2;
+    } else {
+      files.push_back(arg);
+    }
+  }
+  if (files.empty()) {
+    usage();
+    return 2;
+  }
+
+  LogAnalyzer analyzer(config);
+  auto start = std::chrono::steady_clock::now();
+  long long bytes = 0;
+
+  // Birden fazla dosya tek bir akış gibi işlenir (ör. parça parça kayıtlar)
+  for (const char* path : files) {
+    bool useStdin = strcmp(path, "-") == 0;
+    FILE* in = useStdin ? stdin : fopen(path, "rb");
+    if (in == nullptr) {
+      fprintf(stderr, "Dosya açılamadı: %s\n", path);
+      return 1;
+    }
+    long long n = processStream(in, analyzer);
+    if (!useStdin) {
+      fclose(in);
+    }
+    if (n < 0) {
+      fprintf(stderr, "Okuma hatası: %s\n", path);
+      return 1;
+    }
+    bytes += n;
+  }
+  analyzer.finish();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  analyzer.report(stdout);
+  fprintf(stdout, "\n== input ==\n  bytes=%lld parse_s=%.3f mb_per_s=%.1f\n", bytes, seconds,
+          seconds > 0 ? bytes / seconds / 1e6 : 0.0);
+  return 0;
+}
@@ -0,0 +1,474 @@
+/*
+ * ============================================================================
+ * EYA SERIAL RIG - Serial Makine Modu Test Aracı (Host, Linux)
+ * ============================================================================
+ *
+ * TRANSPORT_SERIAL ile derlenmiş firmware'i USB-CDC / UART üzerinden sürer:
+ * makine moduna geçirir, encoder adımları enjekte eder, gelen EVENT
+ * frame'lerini beklenen pozisyonlarla karşılaştırır ve hızı raporlar.
+ *
+ * Kullanım:
+ *   eya-serial-rig [seçenekler] <port>     (ör. /dev/ttyACM0)
+ *
+ * Seçenekler:
+ *   --steps N       Enjekte edilecek adım sayısı (varsayılan 2000)
+ *   --burst K       CMD_INJECT başına adım (count, 1-255, varsayılan 8)
+ *   --window W      Cevabı beklenen en fazla adım (varsayılan 64)
+ *   --baud B        UART hızı (USB-CDC'de önemsiz, varsayılan 115200)
+ *   --timeout-ms T  Cevap bekleme süresi (varsayılan 2000)
+ *   --keep-settle   SETTLE'ı kapatma (varsayılan: test süresince dwell=0)
+ *
+ * Frame formatı device/src/SerialFrame.h'tadır. Çıkış kodu: 0 doğrulama
+ * başarılı, 1 uyumsuzluk / zaman aşımı, 2 kullanım hatası.
+ * ============================================================================
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+#include "SerialFrame.h"
+
+// Firmware'deki EventType ve InjectKind değerleri (EventTransport.h)
+static const uint8_t EV_MAIN_ROTATE = 0;
+static const uint8_t EV_SUB_ROTATE = 1;
+static const uint8_t EV_SETTLE = 6;
+static const uint8_t INJECT_MAIN_STEP = 0;
+static const uint8_t INJECT_SUB_STEP = 1;
+static const uint32_t DEVICE_INJECT_QUEUE = 32;  // SerialEventTransport INJECT_QUEUE_SIZE
+
+struct RigConfig {
+  const char* port = nullptr;
+  uint32_t steps = 2000;
+  uint32_t burst = 8;
+  uint32_t window = 64;
+  uint32_t baud = 115200;
+  uint32_t timeoutMs = 2000;
+  bool keepSettle = false;
+};
+
+struct Expected {
+  uint8_t type;
+  uint8_t mainIndex;
+  uint8_t subIndex;
+};
+
+struct DeviceStateFrame {
+  uint8_t mainIndex = 0;
+  uint8_t subIndex = 0;
+  uint8_t flags = 0;
+  uint16_t dwellMs = 0;
+  uint32_t ts = 0;
+  uint32_t eventSeq = 0;
+  uint32_t rxErrors = 0;
+  uint32_t txDropped = 0;
+};
+
+static double nowMs() {
+  using namespace std::chrono;
+  return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static speed_t baudFlag(uint32_t baud) {
+  switch (baud) {
+    case 9600: return B9600;
+    case 57600: return B57600;
+    case 230400: return B230400;
+    case 460800: return B460800;
+    case 921600: return B921600;
+    default: return B115200;
+  }
+}
+
+class SerialPort {
+public:
+  ~SerialPort() {
+    if (_fd >= 0) {
+      close(_fd);
+    }
+  }
+
+  bool open(const char* path, uint32_t baud) {
+    _fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (_fd < 0) {
+      fprintf(stderr, "Port açılamadı: %s (%s)\n", path, strerror(errno));
+      return false;
+    }
+    termios tio;
+    if (tcgetattr(_fd, &tio) != 0) {
+      fprintf(stderr, "tcgetattr hatası: %s\n", strerror(errno));
+      return false;
+    }
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, baudFlag(baud));
+    cfsetospeed(&tio, baudFlag(baud));
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    if (tcsetattr(_fd, TCSANOW, &tio) != 0) {
+      fprintf(stderr, "tcsetattr hatası: %s\n", strerror(errno));
+      return false;
+    }
+    tcflush(_fd, TCIOFLUSH);
+    return true;
+  }
+
+  bool writeAll(const uint8_t* data, size_t len) {
+    while (len > 0) {
+      ssize_t n = ::write(_fd, data, len);
+      if (n < 0) {
+        if (errno == EAGAIN || errno == EINTR) {
+          pollfd pfd = { _fd, POLLOUT, 0 };
+          ::poll(&pfd, 1, 100);
+          continue;
+        }
+        fprintf(stderr, "Yazma hatası: %s\n", strerror(errno));
+        return false;
+      }
+      data += n;
+      len -= (size_t)n;
+    }
+    return true;
+  }
+
+  // En fazla waitMs bekle, okunan byte sayısını döndür (hata: -1)
+  ssize_t readSome(uint8_t* buf, size_t size, int waitMs) {
+    pollfd pfd = { _fd, POLLIN, 0 };
+    int r = ::poll(&pfd, 1, waitMs);
+    if (r <= 0) {
+      return r;
+    }
+    ssize_t n = ::read(_fd, buf, size);
+    if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+      return 0;
+    }
+    return n;
+  }
+
+private:
+  int _fd = -1;
+};
+
+class Rig {
+public:
+  explicit Rig(const RigConfig& config) : _config(config) {}
+
+  int run() {
+    if (!_port.open(_config.port, _config.baud)) {
+      return 1;
+    }
+    if (!hello()) {
+      fprintf(stderr, "HELLO cevabı yok: firmware TRANSPORT_SERIAL ile derlendi mi?\n");
+      return 1;
+    }
+    DeviceStateFrame start;
+    if (!queryState(&start)) {
+      return 1;
+    }
+    _main = start.mainIndex;
+    _sub = start.subIndex;
+    _lastSeq = start.eventSeq;
+    uint16_t savedDwell = start.dwellMs;
+    // SETTLE event'leri adım akışına karışmasın
+    if (!_config.keepSettle && !setSettle(0)) {
+      return 1;
+    }
+
+    printf("== rig ==\n  port=%s proto=%u start m=%u s=%u seq=%u dwell=%ums\n", _config.port,
+           _protocol, start.mainIndex, start.subIndex, start.eventSeq, start.dwellMs);
+
+    bool ok = inject();
+
+    DeviceStateFrame end;
+    if (!queryState(&end)) {
+      return 1;
+    }
+    std::string stall;
+    queryStall(&stall);
+    if (!_config.keepSettle) {
+      setSettle(savedDwell);
+    }
+    sendCommand(CMD_EXIT, nullptr, 0);
+
+    bool stateOk = end.mainIndex == _main && end.subIndex == _sub && end.eventSeq == _lastSeq;
+    double seconds = (_lastEventMs - _startMs) / 1000.0;
+    printf("\n== result ==\n");
+    printf("  steps=%u events=%u elapsed_s=%.3f events_per_s=%.0f\n", _config.steps, _received,
+           seconds, seconds > 0 ? _received / seconds : 0.0);
+    printf("  seq_gaps=%u mismatches=%u unexpected=%u nacks=%u settles=%u\n", _seqGaps, _mismatches,
+           _unexpected, _nacks, _settles);
+    printf("  host_rx_noise=%u dev_rx_err=%u dev_tx_drop=%u\n", _reader.errors(), end.rxErrors,
+           end.txDropped);
+    printf("  end m=%u/%u s=%u/%u seq=%u/%u (cihaz/beklenen) %s\n", end.mainIndex, _main,
+           end.subIndex, _sub, end.eventSeq, _lastSeq, stateOk ? "OK" : "UYUMSUZ");
+    if (!stall.empty()) {
+      printf("  stall=%s\n", stall.c_str());
+    }
+
+    ok = ok && stateOk && _seqGaps == 0 && _mismatches == 0 && _unexpected == 0 && _nacks == 0 &&
+         end.txDropped == start.txDropped;
+    printf("  verdict=%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+  }
+
+private:
+  RigConfig _config;
+  SerialPort _port;
+  FrameReader _reader;
+  uint8_t _cmdSeq = 0;
+  uint8_t _protocol = 0;
+
+  // Beklenen event'ler (enjeksiyon sırasına göre)
+  std::deque<Expected> _expected;
+  uint8_t _main = 0;
+  uint8_t _sub = 0;
+  uint32_t _lastSeq = 0;
+
+  uint32_t _received = 0;
+  uint32_t _seqGaps = 0;
+  uint32_t _mismatches = 0;
+  uint32_t _unexpected = 0;
+  uint32_t _nacks = 0;
+  uint32_t _settles = 0;
+  double _startMs = 0;
+  double _lastEventMs = 0;
+
+  uint8_t sendCommand(uint8_t type, const uint8_t* payload, size_t len) {
+    uint8_t seq = ++_cmdSeq;
+    if (seq == 0) {
+      seq = _cmdSeq = 1;  // 0 cihazın kendi frame'lerine ayrılmış
+    }
+    uint8_t buf[FRAME_MAX_ENCODED];
+    size_t n = SerialFrame::build(type, seq, payload, len, buf);
+    _port.writeAll(buf, n);
+    return seq;
+  }
+
+  // Frame'leri işle; istenen cevap (type + seq) gelince true. EVENT'ler her zaman doğrulanır
+  bool pump(int waitMs, uint8_t wantType = 0, uint8_t wantSeq = 0) {
+    uint8_t buf[4096];
+    ssize_t n = _port.readSome(buf, sizeof(buf), waitMs);
+    if (n < 0) {
+      fprintf(stderr, "Okuma hatası: %s\n", strerror(errno));
+      return false;
+    }
+    bool found = false;
+    for (ssize_t i = 0; i < n; i++) {
+      if (!_reader.push(buf[i])) {
+        continue;
+      }
+      uint8_t type = _reader.type();
+      if (type == FRAME_EVENT) {
+        onEvent(_reader.payload(), _reader.payloadLen());
+      } else if (type == FRAME_ACK && _reader.payloadLen() >= 2 && _reader.payload()[1] != FRAME_OK) {
+        _nacks++;
+        fprintf(stderr, "NACK cmd=0x%02X status=%u\n", _reader.payload()[0], _reader.payload()[1]);
+      }
+      if (wantType != 0 && type == wantType && _reader.seq() == wantSeq) {
+        found = true;
+        _reply.assign(_reader.payload(), _reader.payload() + _reader.payloadLen());
+      }
+    }
+    return found;
+  }
+
+  std::vector<uint8_t> _reply;
+
+  bool request(uint8_t cmd, const uint8_t* payload, size_t len, uint8_t replyType) {
+    uint8_t seq = sendCommand(cmd, payload, len);
+    double deadline = nowMs() + _config.timeoutMs;
+    while (nowMs() < deadline) {
+      if (pump(20, replyType, seq)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool hello() {
+    for (int attempt = 0; attempt < 5; attempt++) {
+      uint8_t seq = sendCommand(CMD_HELLO, nullptr, 0);
+      double deadline = nowMs() + 300;
+      while (nowMs() < deadline) {
+        if (pump(20, FRAME_HELLO, seq)) {
+          _protocol = _reply.empty() ? 0 : _reply[0];
+          if (_protocol != SERIAL_PROTOCOL_VERSION) {
+            fprintf(stderr, "Protokol sürümü uyumsuz: cihaz=%u rig=%u\n", _protocol, SERIAL_PROTOCOL_VERSION);
+            return false;
+          }
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  bool queryState(DeviceStateFrame* state) {
+    if (!request(CMD_STATE, nullptr, 0, FRAME_STATE) || _reply.size() < 21) {
+      fprintf(stderr, "STATE cevabı yok\n");
+      return false;
+    }
+    const uint8_t* p = _reply.data();
+    state->mainIndex = p[0];
+    state->subIndex = p[1];
+    state->flags = p[2];
+    state->dwellMs = SerialFrame::getU16(p + 3);
+    state->ts = SerialFrame::getU32(p + 5);
+    state->eventSeq = SerialFrame::getU32(p + 9);
+    state->rxErrors = SerialFrame::getU32(p + 13);
+    state->txDropped = SerialFrame::getU32(p + 17);
+    return true;
+  }
+
+  bool queryStall(std::string* out) {
+    uint8_t op = 1;
+    if (!request(CMD_STALL, &op, 1, FRAME_TEXT)) {
+      return false;
+    }
+    out->assign(_reply.begin(), _reply.end());
+    return true;
+  }
+
+  bool setSettle(uint16_t ms) {
+    uint8_t payload[2];
+    SerialFrame::putU16(payload, ms);
+    if (!request(CMD_SETTLE, payload, sizeof(payload), FRAME_ACK) || _reply.size() < 2 ||
+        _reply[1] != FRAME_OK) {
+      fprintf(stderr, "SETTLE ayarlanamadı\n");
+      return false;
+    }
+    return true;
+  }
+
+  // Adımları pencere içinde gönder, tüm event'ler gelene kadar bekle
+  bool inject() {
+    uint32_t sent = 0;
+    uint32_t block = 0;
+    _startMs = nowMs();
+    _lastEventMs = _startMs;
+    double lastProgress = _startMs;
+    uint32_t lastReceived = 0;
+
+    while (_received < _config.steps) {
+      while (sent < _config.steps && _expected.size() + _config.burst <= _config.window) {
+        uint32_t count = _config.burst;
+        if (count > _config.steps - sent) {
+          count = _config.steps - sent;
+        }
+        // Desen: üç blok ana menü ileri, bir blok alt menü geri
+        bool sub = (block++ % 4) == 3;
+        int8_t delta = sub ? -1 : 1;
+        uint8_t payload[3] = { sub ? INJECT_SUB_STEP : INJECT_MAIN_STEP, (uint8_t)delta, (uint8_t)count };
+        for (uint32_t i = 0; i < count; i++) {
+          if (sub) {
+            _sub = (uint8_t)(_sub + delta);
+            _expected.push_back({ EV_SUB_ROTATE, _main, _sub });
+          } else {
+            _main = (uint8_t)(_main + delta);
+            _sub = 0;
+            _expected.push_back({ EV_MAIN_ROTATE, _main, 0 });
+          }
+        }
+        sendCommand(CMD_INJECT, payload, sizeof(payload));
+        sent += count;
+      }
+      pump(5);
+      if (_received != lastReceived) {
+        lastReceived = _received;
+        lastProgress = nowMs();
+      } else if (nowMs() - lastProgress > _config.timeoutMs) {
+        fprintf(stderr, "Zaman aşımı: %u/%u event alındı\n", _received, _config.steps);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void onEvent(const uint8_t* p, size_t len) {
+    if (len < 12) {
+      _unexpected++;
+      return;
+    }
+    uint8_t type = p[0];
+    uint32_t seq = SerialFrame::getU32(p + 8);
+    if (seq != _lastSeq + 1) {
+      _seqGaps++;
+    }
+    _lastSeq = seq;
+    if (type == EV_SETTLE) {
+      _settles++;  // --keep-settle: adım dizisinin parçası değil
+      return;
+    }
+    _lastEventMs = nowMs();
+
+    if (_expected.empty()) {
+      _unexpected++;
+      fprintf(stderr, "Beklenmeyen event type=%u m=%u s=%u seq=%u\n", type, p[1], p[2], seq);
+      return;
+    }
+    Expected e = _expected.front();
+    _expected.pop_front();
+    _received++;
+    if (type != e.type || p[1] != e.mainIndex || p[2] != e.subIndex) {
+      if (_mismatches++ < 10) {
+        fprintf(stderr, "Uyumsuz event seq=%u: type=%u m=%u s=%u, beklenen type=%u m=%u s=%u\n", seq,
+                type, p[1], p[2], e.type, e.mainIndex, e.subIndex);
+      }
+    }
+  }
+};
+
+static void usage() {
+  fprintf(stderr,
+          "Kullanım: eya-serial-rig [--steps N] [--burst K] [--window W] [--baud B] "
+          "[--timeout-ms T] [--keep-settle] <port>\n");
+}
+
+int main(int argc, char** argv) {
+  RigConfig config;
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    if (strcmp(arg, "--steps") == 0 && i + 1 < argc) {
+      config.steps = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--burst") == 0 && i + 1 < argc) {
+      config.burst = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--window") == 0 && i + 1 < argc) {
+      config.window = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--baud") == 0 && i + 1 < argc) {
+      config.baud = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--timeout-ms") == 0 && i + 1 < argc) {
+      config.timeoutMs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(arg, "--keep-settle") == 0) {
+      config.keepSettle = true;
+    } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+      usage();
+      return 0;
+    } else if (arg[0] == '-') {
+      fprintf(stderr, "Bilinmeyen seçenek: %s\n", arg);
+      usage();
+      return 2;
+    } else {
+      config.port = arg;
+    }
+  }
+  if (config.port == nullptr || config.burst == 0 || config.burst > 255 || config.window < config.burst) {
+    usage();
+    return 2;
+  }
+  // Pencere, cihazın komut kuyruğunu taşırmamalı (taşarsa NACK QUEUE_FULL)
+  if ((config.window + config.burst - 1) / config.burst > DEVICE_INJECT_QUEUE) {
+    fprintf(stderr, "--window / --burst en fazla %u komut olabilir\n", DEVICE_INJECT_QUEUE);
+    return 2;
+  }
+
+  Rig rig(config);
+  return rig.run();
+}